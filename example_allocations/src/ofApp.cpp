@@ -0,0 +1,366 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofApp.h"
+#include <cstdlib>
+#include <new>
+
+
+namespace {
+
+
+std::atomic<bool> isCounting(false);
+std::atomic<std::size_t> allocationCount(0);
+
+
+const std::size_t TOUCH_COUNTS[] = { 1, 5, 10, 20 };
+
+
+} // namespace
+
+
+// Count every allocation made while isCounting is set, on any thread.
+void* operator new(std::size_t size)
+{
+    if (isCounting.load(std::memory_order_relaxed))
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+
+void ofApp::setup()
+{
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    // Replace the hardware with a synthetic device.
+    source = new ofx::SyntheticFrameSource(1);
+    pad.setFrameSource(std::unique_ptr<ofx::FrameSource>(source));
+    pad.connect(0);
+
+    results["iterations"] = int(ITERATIONS);
+    results["checks"] = ofJson::array();
+
+    measureNotifyAllocations();
+    checkDispatchModes();
+    checkListeners();
+    checkInputThread();
+
+    results["failures"] = numFailures;
+
+    ofSavePrettyJson("allocations.json", results);
+
+    summary << (numFailures == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    if (numFailures == 0)
+    {
+        ofLogNotice("ofApp::setup") << "No allocations in steady-state frames.";
+    }
+    else
+    {
+        ofLogError("ofApp::setup") << numFailures << " checks allocated.";
+    }
+
+    ofLogNotice("ofApp::setup") << "Results saved to " << ofToDataPath("allocations.json", true);
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofSetColor(255);
+    ofDrawBitmapString(summary.str(), 20, 20);
+}
+
+
+double ofApp::countAllocations(std::size_t iterations, std::function<void()> function)
+{
+    // Let buffers grow to their steady-state size first.
+    for (std::size_t i = 0; i < iterations / 10; ++i)
+    {
+        function();
+    }
+
+    allocationCount = 0;
+    isCounting = true;
+
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+
+    isCounting = false;
+
+    return double(allocationCount.load()) / iterations;
+}
+
+
+std::vector<MTTouch> ofApp::makeFrame(std::size_t numTouches, MTTouchPhase phase)
+{
+    std::vector<MTTouch> touches;
+
+    for (std::size_t i = 0; i < numTouches; ++i)
+    {
+        float x = (i % 5 + 0.5f) / 5.0f;
+        float y = (i / 5 + 0.5f) / 5.0f;
+        touches.push_back(ofx::SyntheticFrameSource::makeTouch(i, phase, x, y));
+    }
+
+    return touches;
+}
+
+
+double ofApp::countFrameAllocations(std::size_t numTouches, std::function<void()> waitForFrame)
+{
+    auto down = makeFrame(numTouches, MTTouchStateMakeTouch);
+    auto touches = makeFrame(numTouches, MTTouchStateTouching);
+
+    source->pushFrame(0, down.data(), down.size(), frameNum / 120.0, frameNum);
+    ++frameNum;
+    dispatchQueuedFrames();
+
+    double allocations = countAllocations(ITERATIONS, [&]()
+    {
+        // Move every touch so each frame is a real move.
+        for (auto& touch: touches)
+        {
+            touch.normalizedVector.position.x = std::fmod(touch.normalizedVector.position.x + 0.001f, 1.0f);
+        }
+
+        source->pushFrame(0, touches.data(), touches.size(), frameNum / 120.0, frameNum);
+        ++frameNum;
+        dispatchQueuedFrames();
+
+        if (waitForFrame)
+        {
+            waitForFrame();
+        }
+    });
+
+    // Lift the touches so the next check starts from an empty pad.
+    auto up = makeFrame(numTouches, MTTouchStateOutOfRange);
+    source->pushFrame(0, up.data(), up.size(), frameNum / 120.0, frameNum);
+    ++frameNum;
+    dispatchQueuedFrames();
+
+    return allocations;
+}
+
+
+void ofApp::measureNotifyAllocations()
+{
+    ofEvent<int> event;
+    int sum = 0;
+
+    ofEventListener listener = event.newListener([&](int& value)
+    {
+        sum += value;
+    });
+
+    notifyAllocations = countAllocations(ITERATIONS, [&]()
+    {
+        int value = 1;
+        ofNotifyEvent(event, value);
+    });
+
+    results["notify_allocations"] = notifyAllocations;
+    summary << "ofNotifyEvent: " << ofToString(notifyAllocations, 3) << " allocations/notify" << std::endl;
+    ofLogNotice("ofApp::measureNotifyAllocations") << "Each notify with a listener makes " << notifyAllocations << " allocations.";
+}
+
+
+void ofApp::dispatchQueuedFrames()
+{
+    // TouchPad dispatches queued frames from the update event.
+    if (pad.getDispatchMode() != ofx::TouchPad::DISPATCH_IMMEDIATE)
+    {
+        ofEventArgs args;
+        ofNotifyEvent(ofEvents().update, args);
+    }
+}
+
+
+std::size_t ofApp::notifiesPerFrame(std::size_t numTouches)
+{
+    std::size_t numNotifies = 0;
+
+    // The app's own touch handlers listen to the legacy events in a running
+    // app, so they may have listeners even without the checks'.
+    if (ofEvents().touchMoved.size() > 0)
+    {
+        numNotifies += numTouches;
+    }
+
+    if (pad.frameEvent().size() > 0)
+    {
+        ++numNotifies;
+    }
+
+    if (pad.getDispatchMode() != ofx::TouchPad::DISPATCH_IMMEDIATE)
+    {
+        // The update event that dispatches the frame.
+        ++numNotifies;
+    }
+
+    return numNotifies;
+}
+
+
+void ofApp::checkDispatchModes()
+{
+    const std::pair<ofx::TouchPad::DispatchMode, std::string> modes[] = {
+        { ofx::TouchPad::DISPATCH_IMMEDIATE, "DISPATCH_IMMEDIATE" },
+        { ofx::TouchPad::DISPATCH_QUEUED, "DISPATCH_QUEUED" },
+        { ofx::TouchPad::DISPATCH_COALESCED, "DISPATCH_COALESCED" }
+    };
+
+    for (const auto& mode: modes)
+    {
+        // Queued frames are dispatched inside the measured loop, so the
+        // update thread's allocations are counted too.
+        pad.setDispatchMode(mode.first);
+
+        for (auto numTouches: TOUCH_COUNTS)
+        {
+            double allocations = countFrameAllocations(numTouches);
+            addResult("dispatch", { { "mode", mode.second }, { "touches", numTouches } }, allocations, notifiesPerFrame(numTouches));
+        }
+    }
+
+    pad.setDispatchMode(ofx::TouchPad::DISPATCH_IMMEDIATE);
+}
+
+
+void ofApp::checkListeners()
+{
+    float sum = 0;
+
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        double touchAllocations = 0;
+        std::size_t touchNotifies = 0;
+
+        {
+            ofEventListener listener = ofEvents().touchMoved.newListener([&](ofTouchEventArgs& touch)
+            {
+                sum += touch.x;
+            });
+
+            touchAllocations = countFrameAllocations(numTouches);
+            touchNotifies = notifiesPerFrame(numTouches);
+        }
+
+        double frameAllocations = 0;
+        std::size_t frameNotifies = 0;
+
+        {
+            ofEventListener listener = pad.frameEvent().newListener([&](const ofx::ContactFrame& frame)
+            {
+                for (const auto& touch: frame.touches)
+                {
+                    sum += touch.x;
+                }
+            });
+
+            frameAllocations = countFrameAllocations(numTouches);
+            frameNotifies = notifiesPerFrame(numTouches);
+        }
+
+        addResult("listeners", { { "event", "touchMoved" }, { "touches", numTouches } }, touchAllocations, touchNotifies);
+        addResult("listeners", { { "event", "frameEvent" }, { "touches", numTouches } }, frameAllocations, frameNotifies);
+    }
+}
+
+
+void ofApp::checkInputThread()
+{
+    pad.startInputThread();
+
+    std::atomic<int32_t> numFrames(0);
+
+    ofEventListener listener = pad.frameEvent().newListener([&](const ofx::ContactFrame&)
+    {
+        ++numFrames;
+    });
+
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        numFrames = 0;
+        int32_t numPushed = 0;
+
+        // The counter is global, so the input thread's allocations are
+        // counted too as long as each frame is processed before the next.
+        double allocations = countFrameAllocations(numTouches, [&]()
+        {
+            ++numPushed;
+
+            while (numFrames.load() <= numPushed)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+        addResult("input_thread", { { "touches", numTouches } }, allocations, notifiesPerFrame(numTouches));
+
+        // Wait for the down frame, the moves and the up frame.
+        while (numFrames.load() < numPushed + 2)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    pad.stopInputThread();
+}
+
+
+void ofApp::addResult(const std::string& name,
+                      ofJson parameters,
+                      double allocationsPerFrame,
+                      std::size_t numNotifies)
+{
+    // Allow for rounding in the per-notify mean.
+    double allowedAllocations = numNotifies * notifyAllocations;
+    bool isPassed = allocationsPerFrame <= allowedAllocations + 0.001;
+
+    if (!isPassed)
+    {
+        ++numFailures;
+    }
+
+    ofJson result;
+    result["name"] = name;
+    result["parameters"] = parameters;
+    result["allocations_per_frame"] = allocationsPerFrame;
+    result["notifies_per_frame"] = numNotifies;
+    result["allowed_allocations_per_frame"] = allowedAllocations;
+    result["passed"] = isPassed;
+    results["checks"].push_back(result);
+
+    summary << name << " " << parameters.dump() << ": " << ofToString(allocationsPerFrame, 3) << " allocations/frame, " << ofToString(allowedAllocations, 3) << " allowed" << std::endl;
+
+    if (isPassed)
+    {
+        ofLogNotice("ofApp::addResult") << name << " " << parameters.dump() << ": " << allocationsPerFrame << " allocations/frame, all in ofNotifyEvent";
+    }
+    else
+    {
+        ofLogError("ofApp::addResult") << name << " " << parameters.dump() << ": " << allocationsPerFrame << " allocations/frame, " << allowedAllocations << " allowed";
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTouchPad.h"
+
+
+/// \brief Checks that steady-state contact frames don't allocate.
+///
+/// Global operator new is replaced with a counting version, and synthetic
+/// frames are pushed through the pipeline in each dispatch mode. Queued
+/// frames are dispatched by notifying the update event after each push.
+///
+/// The pipeline itself should make zero allocations after the warm-up. The
+/// one exception is ofEvent, which copies its listener list on every notify
+/// that has listeners, so each such event is allowed the allocations of one
+/// notify, measured first. The results are printed and saved to
+/// bin/data/allocations.json.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Count the allocations made by a function.
+    /// \param iterations The number of times to call the function.
+    /// \param function The function to call.
+    /// \returns the mean number of allocations per call.
+    static double countAllocations(std::size_t iterations, std::function<void()> function);
+
+    /// \brief Make a frame of touches spread across the pad.
+    static std::vector<MTTouch> makeFrame(std::size_t numTouches, MTTouchPhase phase);
+
+    /// \brief Measure the allocations of one notify of an event that has a
+    /// listener.
+    void measureNotifyAllocations();
+
+    /// \brief Dispatch the queued frames, as the update event does.
+    void dispatchQueuedFrames();
+
+    /// \brief Count the notifies, of events with listeners, made for each
+    /// steady-state move frame.
+    std::size_t notifiesPerFrame(std::size_t numTouches);
+
+    void checkDispatchModes();
+    void checkListeners();
+    void checkInputThread();
+
+    /// \brief Push moving frames from device 0 and count their allocations.
+    /// \param numTouches The number of touches in each frame.
+    /// \param waitForFrame Called after each frame is pushed, to wait until
+    /// it has been processed.
+    /// \returns the mean number of allocations per frame.
+    double countFrameAllocations(std::size_t numTouches,
+                                 std::function<void()> waitForFrame = std::function<void()>());
+
+    /// \brief Record a check.
+    /// \param name The check name.
+    /// \param parameters The check parameters.
+    /// \param allocationsPerFrame The mean allocations per frame.
+    /// \param numNotifies The notifies per frame, each allowed the
+    /// allocations of one notify.
+    void addResult(const std::string& name,
+                   ofJson parameters,
+                   double allocationsPerFrame,
+                   std::size_t numNotifies);
+
+    ofx::TouchPad pad;
+
+    ofx::SyntheticFrameSource* source = nullptr;
+
+    int32_t frameNum = 0;
+
+    /// \brief The mean allocations of one notify with a listener.
+    double notifyAllocations = 0;
+
+    ofJson results;
+    std::stringstream summary;
+
+    std::size_t numFailures = 0;
+
+    enum
+    {
+        ITERATIONS = 10000
+    };
+
+};
@@ -0,0 +1,523 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofApp.h"
+
+
+namespace {
+
+
+const std::size_t TOUCH_COUNTS[] = { 1, 5, 10, 20 };
+
+
+const ofx::TouchPad::ScalingMode SCALING_MODES[] = {
+    ofx::TouchPad::SCALE_TO_WINDOW,
+    ofx::TouchPad::SCALE_TO_RECT,
+    ofx::TouchPad::NORMALIZED,
+    ofx::TouchPad::ABSOLUTE
+};
+
+
+const ofx::KinematicsSettings::Estimator ESTIMATORS[] = {
+    ofx::KinematicsSettings::ESTIMATOR_DRIVER,
+    ofx::KinematicsSettings::ESTIMATOR_FINITE_DIFFERENCE,
+    ofx::KinematicsSettings::ESTIMATOR_LEAST_SQUARES,
+    ofx::KinematicsSettings::ESTIMATOR_ALPHA_BETA
+};
+
+
+std::string toString(ofx::KinematicsSettings::Estimator estimator)
+{
+    switch (estimator)
+    {
+        case ofx::KinematicsSettings::ESTIMATOR_DRIVER: return "ESTIMATOR_DRIVER";
+        case ofx::KinematicsSettings::ESTIMATOR_FINITE_DIFFERENCE: return "ESTIMATOR_FINITE_DIFFERENCE";
+        case ofx::KinematicsSettings::ESTIMATOR_LEAST_SQUARES: return "ESTIMATOR_LEAST_SQUARES";
+        case ofx::KinematicsSettings::ESTIMATOR_ALPHA_BETA: return "ESTIMATOR_ALPHA_BETA";
+    }
+
+    return "UNKNOWN";
+}
+
+
+std::string toString(ofx::TouchPad::ScalingMode mode)
+{
+    switch (mode)
+    {
+        case ofx::TouchPad::SCALE_TO_WINDOW: return "SCALE_TO_WINDOW";
+        case ofx::TouchPad::SCALE_TO_RECT: return "SCALE_TO_RECT";
+        case ofx::TouchPad::NORMALIZED: return "NORMALIZED";
+        case ofx::TouchPad::ABSOLUTE: return "ABSOLUTE";
+    }
+
+    return "UNKNOWN";
+}
+
+
+} // namespace
+
+
+void ofApp::setup()
+{
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    auto& pad = ofx::TouchPad::instance();
+
+    // Replace the hardware with synthetic devices.
+    source = new ofx::SyntheticFrameSource(MAX_DEVICES);
+    pad.setFrameSource(std::unique_ptr<ofx::FrameSource>(source));
+
+    for (int i = 0; i < MAX_DEVICES; ++i)
+    {
+        pad.connect(i);
+    }
+
+    pad.setScalingRect(ofRectangle(100, 100, 800, 600));
+
+    results["kernel"] = ofx::TouchFrame::kernelName();
+    results["iterations"] = int(ITERATIONS);
+    results["benchmarks"] = ofJson::array();
+
+    benchmarkConversion();
+    benchmarkKinematics();
+    benchmarkPipeline();
+    benchmarkDoubleTap();
+    benchmarkActiveTouches();
+    benchmarkListeners();
+    benchmarkInputThread();
+    benchmarkSnapshotReads();
+
+    ofSavePrettyJson("benchmark.json", results);
+
+    ofLogNotice("ofApp::setup") << "Results saved to " << ofToDataPath("benchmark.json", true);
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofSetColor(255);
+    ofDrawBitmapString(summary.str(), 20, 20);
+}
+
+
+double ofApp::measure(std::size_t iterations, std::function<void()> function)
+{
+    // Warm up caches and branch predictors.
+    for (std::size_t i = 0; i < iterations / 10; ++i)
+    {
+        function();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+
+std::vector<MTTouch> ofApp::makeFrame(std::size_t numTouches, MTTouchPhase phase)
+{
+    std::vector<MTTouch> touches;
+
+    for (std::size_t i = 0; i < numTouches; ++i)
+    {
+        float x = (i % 5 + 0.5f) / 5.0f;
+        float y = (i / 5 + 0.5f) / 5.0f;
+        touches.push_back(ofx::SyntheticFrameSource::makeTouch(i, phase, x, y));
+    }
+
+    return touches;
+}
+
+
+void ofApp::benchmarkConversion()
+{
+    ofx::TouchFrame frame;
+
+    for (auto mode: SCALING_MODES)
+    {
+        ofx::TouchFrameTransform transform;
+        transform.normalize = mode != ofx::TouchPad::ABSOLUTE;
+        transform.scaleX = 800;
+        transform.scaleY = 600;
+
+        for (auto numTouches: TOUCH_COUNTS)
+        {
+            auto touches = makeFrame(numTouches, MTTouchStateTouching);
+
+            double ns = measure(ITERATIONS, [&]()
+            {
+                frame.assign(touches.data(), touches.size(), !transform.normalize);
+                frame.transform(transform);
+            });
+
+            addResult("conversion", { { "mode", toString(mode) }, { "touches", numTouches } }, ns);
+        }
+    }
+}
+
+
+void ofApp::benchmarkKinematics()
+{
+    for (auto estimator: ESTIMATORS)
+    {
+        ofx::KinematicsSettings settings;
+        settings.estimator = estimator;
+
+        for (auto numTouches: TOUCH_COUNTS)
+        {
+            auto touches = makeFrame(numTouches, MTTouchStateTouching);
+
+            ofx::TouchFrame frame;
+            frame.assign(touches.data(), touches.size(), false);
+
+            ofx::TouchKinematics kinematics;
+            double timestamp = 0;
+
+            double ns = measure(ITERATIONS, [&]()
+            {
+                // Move every touch so the estimators see fresh samples.
+                for (std::size_t i = 0; i < frame.size(); ++i)
+                {
+                    frame.x[i] += 0.001f;
+                }
+
+                timestamp += 1 / 120.0;
+                kinematics.update(frame, timestamp, settings);
+            });
+
+            addResult("kinematics", { { "estimator", toString(estimator) }, { "touches", numTouches } }, ns);
+        }
+    }
+}
+
+
+void ofApp::benchmarkPipeline()
+{
+    auto& pad = ofx::TouchPad::instance();
+
+    for (auto mode: SCALING_MODES)
+    {
+        pad.setScalingMode(mode);
+
+        for (int numDevices = 1; numDevices <= MAX_DEVICES; ++numDevices)
+        {
+            for (auto numTouches: TOUCH_COUNTS)
+            {
+                auto touches = makeFrame(numTouches, MTTouchStateTouching);
+                int32_t frameNum = 0;
+
+                double ns = measure(ITERATIONS, [&]()
+                {
+                    double timestamp = frameNum / 120.0;
+
+                    for (int device = 0; device < numDevices; ++device)
+                    {
+                        source->pushFrame(device, touches.data(), touches.size(), timestamp, frameNum);
+                    }
+
+                    ++frameNum;
+                });
+
+                addResult("pipeline",
+                          { { "mode", toString(mode) }, { "devices", numDevices }, { "touches", numTouches } },
+                          ns / numDevices);
+            }
+        }
+    }
+
+    pad.setScalingMode(ofx::TouchPad::SCALE_TO_WINDOW);
+}
+
+
+void ofApp::benchmarkDoubleTap()
+{
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        // Alternate down and up frames so every frame goes through tap detection.
+        auto down = makeFrame(numTouches, MTTouchStateMakeTouch);
+        auto up = makeFrame(numTouches, MTTouchStateOutOfRange);
+        int32_t frameNum = 0;
+
+        double ns = measure(ITERATIONS, [&]()
+        {
+            const auto& touches = frameNum % 2 ? up : down;
+            source->pushFrame(0, touches.data(), touches.size(), frameNum / 120.0, frameNum);
+            ++frameNum;
+        });
+
+        addResult("double_tap", { { "touches", numTouches } }, ns);
+    }
+}
+
+
+void ofApp::benchmarkActiveTouches()
+{
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        // A frame of moves, as dispatched while fingers are down.
+        std::vector<ofTouchEventArgs> touches;
+
+        for (std::size_t i = 0; i < numTouches; ++i)
+        {
+            ofTouchEventArgs touch;
+            touch.type = ofTouchEventArgs::move;
+            touch.id = ofx::TouchPad::touchId(0, i);
+            touches.push_back(touch);
+        }
+
+        float offset = 0;
+
+        // The previous approach: rebuild a map from every frame.
+        std::map<int, ofTouchEventArgs> map;
+
+        double mapNs = measure(ITERATIONS, [&]()
+        {
+            offset += 0.001f;
+            map.clear();
+
+            for (auto& touch: touches)
+            {
+                touch.x = offset;
+                map[touch.id] = touch;
+            }
+        });
+
+        ofx::ActiveTouchTable table;
+
+        double tableNs = measure(ITERATIONS, [&]()
+        {
+            offset += 0.001f;
+
+            for (auto& touch: touches)
+            {
+                touch.x = offset;
+                table.insert(touch, touch);
+            }
+        });
+
+        addResult("active_touches", { { "table", "std::map rebuild" }, { "touches", numTouches } }, mapNs);
+        addResult("active_touches", { { "table", "ActiveTouchTable" }, { "touches", numTouches } }, tableNs);
+    }
+}
+
+
+void ofApp::benchmarkListeners()
+{
+    auto& pad = ofx::TouchPad::instance();
+
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        auto touches = makeFrame(numTouches, MTTouchStateTouching);
+        int32_t frameNum = 0;
+        float sum = 0;
+
+        auto pushFrames = [&]()
+        {
+            source->pushFrame(0, touches.data(), touches.size(), frameNum / 120.0, frameNum);
+            ++frameNum;
+        };
+
+        double touchNs = 0;
+
+        {
+            ofEventListener listener = ofEvents().touchMoved.newListener([&](ofTouchEventArgs& touch)
+            {
+                sum += touch.x;
+            });
+
+            touchNs = measure(ITERATIONS, pushFrames);
+        }
+
+        double frameNs = 0;
+        double frameOnlyNs = 0;
+
+        {
+            ofEventListener listener = pad.frameEvent().newListener([&](const ofx::ContactFrame& frame)
+            {
+                for (const auto& touch: frame.touches)
+                {
+                    sum += touch.x;
+                }
+            });
+
+            // The app's own touch handlers keep the core events busy, so a
+            // frame listener alone only saves work once they are disabled.
+            frameNs = measure(ITERATIONS, pushFrames);
+
+            pad.disableCoreTouchEvents();
+            frameOnlyNs = measure(ITERATIONS, pushFrames);
+            pad.enableCoreTouchEvents();
+        }
+
+        addResult("listeners", { { "event", "touchMoved" }, { "touches", numTouches } }, touchNs);
+        addResult("listeners", { { "event", "frameEvent" }, { "core_touch_events", true }, { "touches", numTouches } }, frameNs);
+        addResult("listeners", { { "event", "frameEvent" }, { "core_touch_events", false }, { "touches", numTouches } }, frameOnlyNs);
+    }
+}
+
+
+void ofApp::benchmarkInputThread()
+{
+    auto& pad = ofx::TouchPad::instance();
+
+    // A listener that does some app work for every moved touch.
+    ofEventListener listener = ofEvents().touchMoved.newListener([&](ofTouchEventArgs&)
+    {
+        auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(2);
+        while (std::chrono::steady_clock::now() < end);
+    });
+
+    for (int useInputThread = 0; useInputThread < 2; ++useInputThread)
+    {
+        if (useInputThread)
+        {
+            pad.startInputThread();
+        }
+
+        for (auto numTouches: TOUCH_COUNTS)
+        {
+            auto touches = makeFrame(numTouches, MTTouchStateTouching);
+            std::chrono::steady_clock::duration callbackTime(0);
+
+            for (int32_t frameNum = 0; frameNum < INPUT_THREAD_FRAMES; ++frameNum)
+            {
+                // Only the driver callback is timed. Frames arrive at 120 Hz
+                // like a trackpad, so the input thread keeps up.
+                auto start = std::chrono::steady_clock::now();
+                source->pushFrame(0, touches.data(), touches.size(), frameNum / 120.0, frameNum);
+                auto end = std::chrono::steady_clock::now();
+                callbackTime += end - start;
+
+                std::this_thread::sleep_until(start + std::chrono::microseconds(8333));
+            }
+
+            double ns = std::chrono::duration<double, std::nano>(callbackTime).count() / INPUT_THREAD_FRAMES;
+
+            addResult("driver_callback",
+                      { { "input_thread", bool(useInputThread) }, { "touches", numTouches } },
+                      ns);
+        }
+    }
+
+    pad.stopInputThread();
+}
+
+
+void ofApp::benchmarkSnapshotReads()
+{
+    auto& pad = ofx::TouchPad::instance();
+
+    for (auto numTouches: TOUCH_COUNTS)
+    {
+        auto touches = makeFrame(numTouches, MTTouchStateTouching);
+
+        // The previous approach: every frame updates a std::map under a
+        // mutex, and readers copy it under the same mutex.
+        std::mutex mapMutex;
+        std::map<int, ofTouchEventArgs> map;
+
+        std::vector<ofTouchEventArgs> events;
+
+        for (const auto& touch: touches)
+        {
+            ofTouchEventArgs event;
+            event.type = ofTouchEventArgs::move;
+            event.id = ofx::TouchPad::touchId(0, touch.pathIndex);
+            events.push_back(event);
+        }
+
+        // Write frames continuously from another thread, like the driver.
+        std::atomic<bool> writing(true);
+
+        std::thread writer([&]()
+        {
+            int32_t frameNum = 0;
+
+            while (writing)
+            {
+                source->pushFrame(0, touches.data(), touches.size(), frameNum / 120.0, frameNum);
+
+                {
+                    std::unique_lock<std::mutex> lock(mapMutex);
+
+                    for (auto& event: events)
+                    {
+                        event.x = frameNum;
+                        map[event.id] = event;
+                    }
+                }
+
+                ++frameNum;
+            }
+        });
+
+        float sum = 0;
+
+        double snapshotNs = measure(ITERATIONS, [&]()
+        {
+            for (const auto& touch: pad.snapshot())
+            {
+                sum += touch.x;
+            }
+        });
+
+        double touchesNs = measure(ITERATIONS, [&]()
+        {
+            for (const auto& touch: pad.touches())
+            {
+                sum += touch.x;
+            }
+        });
+
+        double mapNs = measure(ITERATIONS, [&]()
+        {
+            std::vector<ofTouchEventArgs> copy;
+
+            {
+                std::unique_lock<std::mutex> lock(mapMutex);
+
+                for (const auto& touch: map)
+                {
+                    copy.push_back(touch.second);
+                }
+            }
+
+            for (const auto& touch: copy)
+            {
+                sum += touch.x;
+            }
+        });
+
+        writing = false;
+        writer.join();
+
+        addResult("snapshot_read", { { "api", "snapshot" }, { "touches", numTouches } }, snapshotNs);
+        addResult("snapshot_read", { { "api", "touches" }, { "touches", numTouches } }, touchesNs);
+        addResult("snapshot_read", { { "api", "mutex + std::map copy" }, { "touches", numTouches } }, mapNs);
+    }
+}
+
+
+void ofApp::addResult(const std::string& name, ofJson parameters, double nsPerFrame)
+{
+    ofJson result;
+    result["name"] = name;
+    result["parameters"] = parameters;
+    result["ns_per_frame"] = nsPerFrame;
+    results["benchmarks"].push_back(result);
+
+    summary << name << " " << parameters.dump() << ": " << ofToString(nsPerFrame, 1) << " ns/frame" << std::endl;
+    ofLogNotice("ofApp::addResult") << name << " " << parameters.dump() << ": " << nsPerFrame << " ns/frame";
+}
@@ -0,0 +1,57 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTouchPad.h"
+
+
+/// \brief Measures the TouchPad pipeline with synthetic contact frames.
+///
+/// The results are printed and saved to bin/data/benchmark.json so they can
+/// be compared between commits.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Time a function.
+    /// \param iterations The number of times to call the function.
+    /// \param function The function to time.
+    /// \returns the mean time per call in nanoseconds.
+    static double measure(std::size_t iterations, std::function<void()> function);
+
+    /// \brief Make a frame of touches spread across the pad.
+    static std::vector<MTTouch> makeFrame(std::size_t numTouches, MTTouchPhase phase);
+
+    void benchmarkConversion();
+    void benchmarkKinematics();
+    void benchmarkPipeline();
+    void benchmarkDoubleTap();
+    void benchmarkActiveTouches();
+    void benchmarkListeners();
+    void benchmarkInputThread();
+    void benchmarkSnapshotReads();
+
+    void addResult(const std::string& name, ofJson parameters, double nsPerFrame);
+
+    ofx::SyntheticFrameSource* source = nullptr;
+
+    ofJson results;
+    std::stringstream summary;
+
+    enum
+    {
+        ITERATIONS = 20000,
+        MAX_DEVICES = 4,
+        INPUT_THREAD_FRAMES = 120
+    };
+
+};
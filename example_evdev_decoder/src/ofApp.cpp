@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofApp.h"
+
+
+namespace {
+
+
+std::string toString(MTTouchPhase phase)
+{
+    switch (phase)
+    {
+        case MTTouchStateNotTracking: return "NotTracking";
+        case MTTouchStateStartInRange: return "StartInRange";
+        case MTTouchStateHoverInRange: return "HoverInRange";
+        case MTTouchStateMakeTouch: return "MakeTouch";
+        case MTTouchStateTouching: return "Touching";
+        case MTTouchStateBreakTouch: return "BreakTouch";
+        case MTTouchStateLingerInRange: return "LingerInRange";
+        case MTTouchStateOutOfRange: return "OutOfRange";
+    }
+
+    return "unknown";
+}
+
+
+} // namespace
+
+
+void ofApp::setup()
+{
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    ofx::EvdevRecording recording;
+
+    if (!recording.load("two_fingers.evemu"))
+    {
+        check("load", "false", "true");
+    }
+
+    ofx::EvdevDecoder decoder;
+    recording.configure(decoder);
+
+    std::vector<std::string> frames;
+    std::vector<int32_t> frameNums;
+    std::string firstPosition;
+
+    decoder.setFrameCallback([&](const MTTouch* touches,
+                                 int32_t numTouches,
+                                 double timestamp,
+                                 int32_t frameNum)
+    {
+        frames.push_back(describe(touches, numTouches));
+        frameNums.push_back(frameNum);
+
+        if (firstPosition.empty() && numTouches > 0)
+        {
+            firstPosition = ofToString(touches[0].normalizedVector.position.x, 2) + ", "
+                          + ofToString(touches[0].normalizedVector.position.y, 2) + " / "
+                          + ofToString(touches[0].absoluteVector.position.x, 1) + "mm";
+        }
+    });
+
+    for (const auto& event: recording.events)
+    {
+        decoder.decode(event);
+    }
+
+    check("name", recording.name, "Synthetic Touchpad");
+    check("axis", ofToString(decoder.axis(ofx::EvdevDecoder::CODE_MT_POSITION_X).maximum), "1000");
+
+    // The dropped frame isn't delivered, so there are six.
+    check("frame count", ofToString(frames.size()), "6");
+    std::vector<std::string> numbers;
+
+    for (auto frameNum: frameNums)
+    {
+        numbers.push_back(ofToString(frameNum));
+    }
+
+    check("frame numbers", ofJoinString(numbers, " "), "0 1 2 3 4 5");
+
+    // Origin at the bottom left, and 10 units per millimeter.
+    check("position", firstPosition, "0.10, 0.88 / 10.0mm");
+
+    const std::vector<std::string> expected = {
+        "MakeTouch 100, MakeTouch 101",
+        "Touching 100, Touching 101",
+        "Touching 100, OutOfRange 101, MakeTouch 102",
+        "Touching 100, Touching 102",
+        "OutOfRange 100, OutOfRange 102",
+        ""
+    };
+
+    const std::string names[] = {
+        "touches land",
+        "touches move",
+        "slot reused within a frame",
+        "events dropped by SYN_DROPPED are skipped",
+        "touches lift",
+        "empty frame"
+    };
+
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        check(names[i], i < frames.size() ? frames[i] : "missing", expected[i]);
+    }
+
+    summary << (numFailures == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    if (numFailures == 0)
+    {
+        ofLogNotice("ofApp::setup") << "Every check passed.";
+    }
+    else
+    {
+        ofLogError("ofApp::setup") << numFailures << " checks failed.";
+    }
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofSetColor(255);
+    ofDrawBitmapString(summary.str(), 20, 20);
+}
+
+
+std::string ofApp::describe(const MTTouch* touches, int32_t numTouches)
+{
+    std::vector<std::string> descriptions;
+
+    for (int32_t i = 0; i < numTouches; ++i)
+    {
+        descriptions.push_back(toString(touches[i].phase) + " " + ofToString(touches[i].pathIndex));
+    }
+
+    return ofJoinString(descriptions, ", ");
+}
+
+
+void ofApp::check(const std::string& name, const std::string& actual, const std::string& expected)
+{
+    if (actual == expected)
+    {
+        summary << "PASS " << name << std::endl;
+        ofLogNotice("ofApp::check") << "PASS " << name;
+    }
+    else
+    {
+        ++numFailures;
+        summary << "FAIL " << name << ": " << actual << std::endl;
+        ofLogError("ofApp::check") << "FAIL " << name << ": expected \"" << expected << "\", got \"" << actual << "\"";
+    }
+}
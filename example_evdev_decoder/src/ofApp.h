@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTouchPad.h"
+
+
+/// \brief Checks the EvdevDecoder with a recorded event stream.
+///
+/// bin/data/two_fingers.evemu is loaded with EvdevRecording and decoded
+/// without any hardware. The frames are compared with the expected touches,
+/// including a slot that is reused within one frame and events dropped by
+/// the kernel. The results are printed and drawn.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \returns the touches in a frame, e.g. "MakeTouch 100, Touching 101".
+    static std::string describe(const MTTouch* touches, int32_t numTouches);
+
+    void check(const std::string& name, const std::string& actual, const std::string& expected);
+
+    std::stringstream summary;
+
+    std::size_t numFailures = 0;
+
+};
@@ -0,0 +1,234 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofApp.h"
+
+
+namespace {
+
+
+const ofx::KinematicsSettings::Estimator ESTIMATORS[] = {
+    ofx::KinematicsSettings::ESTIMATOR_DRIVER,
+    ofx::KinematicsSettings::ESTIMATOR_FINITE_DIFFERENCE,
+    ofx::KinematicsSettings::ESTIMATOR_LEAST_SQUARES,
+    ofx::KinematicsSettings::ESTIMATOR_ALPHA_BETA
+};
+
+
+std::string toString(ofx::KinematicsSettings::Estimator estimator)
+{
+    switch (estimator)
+    {
+        case ofx::KinematicsSettings::ESTIMATOR_DRIVER: return "ESTIMATOR_DRIVER";
+        case ofx::KinematicsSettings::ESTIMATOR_FINITE_DIFFERENCE: return "ESTIMATOR_FINITE_DIFFERENCE";
+        case ofx::KinematicsSettings::ESTIMATOR_LEAST_SQUARES: return "ESTIMATOR_LEAST_SQUARES";
+        case ofx::KinematicsSettings::ESTIMATOR_ALPHA_BETA: return "ESTIMATOR_ALPHA_BETA";
+    }
+
+    return "UNKNOWN";
+}
+
+
+} // namespace
+
+
+void ofApp::setup()
+{
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    // Prediction horizons in seconds, up to about three frames at 60 Hz.
+    horizons = { 0.0f, 0.008f, 0.016f, 0.025f, 0.033f, 0.050f };
+
+    if (!replay.load("session.touches"))
+    {
+        summary << "Record bin/data/session.touches with TouchPad::recorder() first." << std::endl;
+        return;
+    }
+
+    results["frames"] = replay.frameCount();
+    results["duration"] = replay.duration();
+    results["evaluations"] = ofJson::array();
+
+    for (auto estimator: ESTIMATORS)
+    {
+        ofx::KinematicsSettings settings;
+        settings.estimator = estimator;
+        evaluate(settings, predict(settings));
+    }
+
+    ofSavePrettyJson("prediction.json", results);
+
+    ofLogNotice("ofApp::setup") << "Results saved to " << ofToDataPath("prediction.json", true);
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofSetColor(255);
+    ofDrawBitmapString(summary.str(), 20, 20);
+}
+
+
+std::vector<ofApp::Stroke> ofApp::predict(const ofx::KinematicsSettings& settings)
+{
+    std::vector<Stroke> strokes;
+
+    std::vector<ofx::TouchFrame> frames(replay.numDevices());
+    std::vector<ofx::TouchKinematics> kinematics(replay.numDevices());
+
+    // The stroke of each (device, path index) that is down.
+    std::map<std::pair<int, int32_t>, std::size_t> openStrokes;
+
+    std::vector<std::pair<std::size_t, std::size_t>> samples;
+
+    replay.setFrameCallback([&](int deviceId,
+                                const MTTouch* touches,
+                                int32_t numTouches,
+                                double timestamp,
+                                int32_t frameNum)
+    {
+        // Evaluate in millimeters on the pad.
+        ofx::TouchFrame& frame = frames[deviceId];
+        frame.assign(touches, numTouches, true);
+        kinematics[deviceId].update(frame, timestamp, settings);
+
+        samples.clear();
+
+        for (std::size_t i = 0; i < frame.size(); ++i)
+        {
+            auto key = std::make_pair(deviceId, frame.pathIndex[i]);
+
+            if (frame.phase[i] == MTTouchStateMakeTouch)
+            {
+                openStrokes[key] = strokes.size();
+                strokes.push_back(Stroke());
+            }
+            else if (frame.phase[i] != MTTouchStateTouching)
+            {
+                openStrokes.erase(key);
+                continue;
+            }
+
+            auto iter = openStrokes.find(key);
+
+            if (iter != openStrokes.end())
+            {
+                Sample sample;
+                sample.timestamp = timestamp;
+                sample.position = glm::vec2(frame.x[i], frame.y[i]);
+                strokes[iter->second].push_back(sample);
+                samples.push_back(std::make_pair(i, iter->second));
+            }
+        }
+
+        for (auto horizon: horizons)
+        {
+            ofx::TouchKinematics::predict(frame, horizon);
+
+            for (const auto& sample: samples)
+            {
+                strokes[sample.second].back().predictions.push_back(glm::vec2(frame.predictedX[sample.first],
+                                                                              frame.predictedY[sample.first]));
+            }
+        }
+    });
+
+    for (std::size_t i = 0; i < replay.numDevices(); ++i)
+    {
+        replay.connect(i);
+    }
+
+    while (replay.step())
+    {
+    }
+
+    for (std::size_t i = 0; i < replay.numDevices(); ++i)
+    {
+        replay.disconnect(i);
+    }
+
+    replay.stop();
+
+    return strokes;
+}
+
+
+bool ofApp::positionAt(const Stroke& stroke, double timestamp, glm::vec2& position)
+{
+    auto after = std::lower_bound(stroke.begin(),
+                                  stroke.end(),
+                                  timestamp,
+                                  [](const Sample& sample, double value)
+                                  {
+                                      return sample.timestamp < value;
+                                  });
+
+    if (after == stroke.end())
+    {
+        return false;
+    }
+
+    if (after == stroke.begin() || after->timestamp == timestamp)
+    {
+        position = after->position;
+        return true;
+    }
+
+    auto before = after - 1;
+    float amount = (timestamp - before->timestamp) / (after->timestamp - before->timestamp);
+    position = glm::mix(before->position, after->position, amount);
+    return true;
+}
+
+
+void ofApp::evaluate(const ofx::KinematicsSettings& settings, const std::vector<Stroke>& strokes)
+{
+    for (std::size_t h = 0; h < horizons.size(); ++h)
+    {
+        std::vector<float> errors;
+
+        for (const auto& stroke: strokes)
+        {
+            for (const auto& sample: stroke)
+            {
+                glm::vec2 actual;
+
+                if (positionAt(stroke, sample.timestamp + horizons[h], actual))
+                {
+                    errors.push_back(glm::distance(sample.predictions[h], actual));
+                }
+            }
+        }
+
+        ofJson result;
+        result["estimator"] = toString(settings.estimator);
+        result["horizon"] = horizons[h];
+        result["samples"] = errors.size();
+
+        if (!errors.empty())
+        {
+            std::sort(errors.begin(), errors.end());
+
+            double sum = 0;
+
+            for (auto error: errors)
+            {
+                sum += error;
+            }
+
+            result["mean_error"] = sum / errors.size();
+            result["p95_error"] = errors[std::min(errors.size() - 1, errors.size() * 95 / 100)];
+            result["max_error"] = errors.back();
+        }
+
+        results["evaluations"].push_back(result);
+
+        summary << toString(settings.estimator) << " " << ofToString(horizons[h] * 1000, 0) << " ms: " << result.dump() << std::endl;
+        ofLogNotice("ofApp::evaluate") << result.dump();
+    }
+}
@@ -0,0 +1,60 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTouchPad.h"
+
+
+/// \brief Evaluates touch position prediction against a recording.
+///
+/// The recording (bin/data/session.touches, made with TouchPad::recorder())
+/// is replayed once for each velocity estimator. Every touch position is
+/// predicted at several horizons and compared with the recorded position at
+/// that time. Errors are in millimeters on the pad and are printed and saved
+/// to bin/data/prediction.json.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief A recorded position and its predictions.
+    struct Sample
+    {
+        double timestamp = 0;
+        glm::vec2 position;
+        std::vector<glm::vec2> predictions;
+    };
+
+    /// \brief The samples of one contact, from down to up.
+    typedef std::vector<Sample> Stroke;
+
+    /// \brief Replay the recording and predict every touch.
+    /// \param settings The estimator options.
+    /// \returns the strokes in the recording.
+    std::vector<Stroke> predict(const ofx::KinematicsSettings& settings);
+
+    /// \brief Find the recorded position of a stroke at a given time.
+    /// \param stroke The stroke.
+    /// \param timestamp The time.
+    /// \param position Set to the interpolated position.
+    /// \returns false if the time is after the end of the stroke.
+    static bool positionAt(const Stroke& stroke, double timestamp, glm::vec2& position);
+
+    void evaluate(const ofx::KinematicsSettings& settings, const std::vector<Stroke>& strokes);
+
+    ofx::ReplayFrameSource replay;
+
+    std::vector<float> horizons;
+
+    ofJson results;
+    std::stringstream summary;
+
+};
@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofApp.h"
+
+
+namespace {
+
+
+std::string toString(ofTouchEventArgs::Type type)
+{
+    switch (type)
+    {
+        case ofTouchEventArgs::down: return "down";
+        case ofTouchEventArgs::up: return "up";
+        case ofTouchEventArgs::move: return "move";
+        case ofTouchEventArgs::doubleTap: return "doubleTap";
+        case ofTouchEventArgs::cancel: return "cancel";
+    }
+
+    return "unknown";
+}
+
+
+} // namespace
+
+
+void ofApp::setup()
+{
+    ofSetLogLevel(OF_LOG_NOTICE);
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        check("tap",
+              run(tracker, {
+                  { { 1, MTTouchStateMakeTouch } },
+                  { { 1, MTTouchStateTouching } },
+                  { { 1, MTTouchStateBreakTouch } },
+                  { { 1, MTTouchStateOutOfRange } } }),
+              "down 1 | move 1 | up 1, hover down 1 | hover up 1");
+        check("tap leaves nothing", ofToString(tracker.size()), "0");
+    }
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        check("missed MakeTouch",
+              run(tracker, {
+                  { { 1, MTTouchStateHoverInRange } },
+                  { { 1, MTTouchStateTouching } },
+                  { { 2, MTTouchStateTouching }, { 1, MTTouchStateTouching } } }),
+              "hover down 1 | down 1, hover up 1 | down 2, move 1");
+        check("missed MakeTouch state", ofToString(tracker.state(2)), ofToString(ofx::TouchPhaseTracker::STATE_TOUCHING));
+    }
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        check("missed BreakTouch",
+              run(tracker, {
+                  { { 1, MTTouchStateTouching }, { 2, MTTouchStateTouching } },
+                  { { 1, MTTouchStateLingerInRange }, { 2, MTTouchStateOutOfRange } },
+                  { { 1, MTTouchStateOutOfRange } } }),
+              "down 1, down 2 | up 1, up 2, hover down 1 | hover up 1");
+        check("missed BreakTouch leaves nothing", ofToString(tracker.size()), "0");
+    }
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        check("NotTracking",
+              run(tracker, {
+                  { { 1, MTTouchStateTouching }, { 2, MTTouchStateHoverInRange } },
+                  { { 1, MTTouchStateNotTracking }, { 2, MTTouchStateNotTracking } },
+                  { { 1, MTTouchStateNotTracking } } }),
+              "down 1, hover down 2 | cancel 1, hover up 2 | ");
+        check("NotTracking leaves nothing", ofToString(tracker.size()), "0");
+    }
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        check("missing from a frame",
+              run(tracker, {
+                  { { 1, MTTouchStateTouching }, { 2, MTTouchStateTouching }, { 3, MTTouchStateHoverInRange } },
+                  { { 2, MTTouchStateTouching } },
+                  { } }),
+              "down 1, down 2, hover down 3 | move 2, cancel 1, hover up 3 | cancel 2");
+        check("missing from a frame leaves nothing", ofToString(tracker.size()), "0");
+    }
+
+    {
+        ofx::TouchPhaseTracker tracker;
+        run(tracker, { { { 1, MTTouchStateTouching }, { 2, MTTouchStateHoverInRange } } });
+
+        ofx::ContactFrame frame;
+        tracker.cancelAll(frame);
+
+        check("cancelAll", describe(frame), "cancel 1, hover up 2");
+        check("cancelAll leaves nothing", ofToString(tracker.size()), "0");
+        check("cancelAll then touch",
+              run(tracker, { { { 1, MTTouchStateTouching } } }),
+              "down 1");
+    }
+
+    summary << (numFailures == 0 ? "PASSED" : "FAILED") << std::endl;
+
+    if (numFailures == 0)
+    {
+        ofLogNotice("ofApp::setup") << "Every check passed.";
+    }
+    else
+    {
+        ofLogError("ofApp::setup") << numFailures << " checks failed.";
+    }
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+    ofSetColor(255);
+    ofDrawBitmapString(summary.str(), 20, 20);
+}
+
+
+std::string ofApp::run(ofx::TouchPhaseTracker& tracker, const std::vector<Frame>& frames)
+{
+    std::string result;
+
+    for (const auto& steps: frames)
+    {
+        ofx::ContactFrame frame;
+
+        tracker.beginFrame();
+
+        for (const auto& step: steps)
+        {
+            ofTouchEventArgs touch;
+            touch.id = step.touchId;
+            tracker.update(touch, glm::vec2(0, 0), step.phase, frame);
+        }
+
+        tracker.endFrame(frame);
+
+        result += (result.empty() ? "" : " | ") + describe(frame);
+    }
+
+    return result;
+}
+
+
+std::string ofApp::describe(const ofx::ContactFrame& frame)
+{
+    std::vector<std::string> events;
+
+    for (const auto& touch: frame.touches)
+    {
+        events.push_back(toString(touch.type) + " " + ofToString(touch.id));
+    }
+
+    for (const auto& touch: frame.hovers)
+    {
+        events.push_back("hover " + toString(touch.type) + " " + ofToString(touch.id));
+    }
+
+    return ofJoinString(events, ", ");
+}
+
+
+void ofApp::check(const std::string& name, const std::string& actual, const std::string& expected)
+{
+    if (actual == expected)
+    {
+        summary << "PASS " << name << std::endl;
+        ofLogNotice("ofApp::check") << "PASS " << name;
+    }
+    else
+    {
+        ++numFailures;
+        summary << "FAIL " << name << ": " << actual << std::endl;
+        ofLogError("ofApp::check") << "FAIL " << name << ": expected \"" << expected << "\", got \"" << actual << "\"";
+    }
+}
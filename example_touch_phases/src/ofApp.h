@@ -0,0 +1,50 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxTouchPad.h"
+
+
+/// \brief Checks the TouchPhaseTracker lifecycle with synthetic phases.
+///
+/// Each check drives a tracker directly with a sequence of frames and
+/// compares the events it appends with the expected events. The results are
+/// printed and drawn.
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief A touch in a synthetic frame.
+    struct Step
+    {
+        int touchId;
+        MTTouchPhase phase;
+    };
+
+    typedef std::vector<Step> Frame;
+
+    /// \brief Run frames through a tracker.
+    /// \param tracker The tracker to drive.
+    /// \param frames The frames, in order.
+    /// \returns the events of each frame, separated by " | ".
+    static std::string run(ofx::TouchPhaseTracker& tracker, const std::vector<Frame>& frames);
+
+    /// \returns the events in a frame, e.g. "down 1, hover up 2".
+    static std::string describe(const ofx::ContactFrame& frame);
+
+    void check(const std::string& name, const std::string& actual, const std::string& expected);
+
+    std::stringstream summary;
+
+    std::size_t numFailures = 0;
+
+};
@@ -44,13 +44,16 @@ void ofApp::draw()
     
     auto& pad = ofx::TouchPad::instance();
 
-    ofDrawBitmapString("TouchCount: " + ofToString(pad.touchCount(), 0), 20, 20);
+    // The snapshot is a lock-free view of the touches in the latest frame.
+    const auto& snapshot = pad.snapshot();
+
+    ofDrawBitmapString("TouchCount: " + ofToString(snapshot.size(), 0), 20, 20);
     
     ofFill();
     ofSetColor(255, 255, 255, 100);
     ofDrawRectRounded(pad.getScalingRect(), 10);
     
-    for (const auto& touch: pad.touches())
+    for (const auto& touch: snapshot)
     {
         ofPushMatrix();
         ofTranslate(touch);
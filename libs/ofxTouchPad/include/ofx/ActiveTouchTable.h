@@ -0,0 +1,117 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include "ofx/TouchBuffer.h"
+
+
+namespace ofx {
+
+
+/// \brief The touches that are down, keyed by touch id.
+///
+/// The table is updated in place as touch events arrive: a touch is inserted
+/// when it goes down, updated while it moves and erased when it goes up. Each
+/// touch keeps the same slot from down to up, so slot indices can be held
+/// across frames.
+///
+/// Slots live in fixed storage and are found through a small open-addressed
+/// index with linear probing, so nothing is allocated after construction.
+class ActiveTouchTable
+{
+public:
+    enum
+    {
+        /// \brief The maximum number of active touches.
+        CAPACITY = TouchBuffer::CAPACITY,
+        /// \brief Returned when a touch has no slot.
+        NO_SLOT = CAPACITY
+    };
+
+    ActiveTouchTable();
+
+    /// \brief Insert a touch, or update it if it is already active.
+    /// \param touch The touch.
+    /// \param predicted The predicted position of the touch.
+    /// \returns the slot of the touch, or NO_SLOT if the table is full.
+    std::size_t insert(const ofTouchEventArgs& touch, const glm::vec2& predicted);
+
+    /// \brief Remove a touch.
+    /// \param touchId The touch id.
+    /// \returns true if the touch was active.
+    bool erase(int touchId);
+
+    /// \brief Remove all touches.
+    void clear();
+
+    /// \returns the slot of a touch, or NO_SLOT if it isn't active.
+    std::size_t find(int touchId) const;
+
+    /// \returns true if the slot holds an active touch.
+    bool occupied(std::size_t slot) const
+    {
+        return _occupied[slot];
+    }
+
+    /// \returns the touch in an occupied slot.
+    const ofTouchEventArgs& operator [] (std::size_t slot) const
+    {
+        return _touches[slot];
+    }
+
+    /// \returns the predicted position of the touch in an occupied slot.
+    const glm::vec2& predicted(std::size_t slot) const
+    {
+        return _predicted[slot];
+    }
+
+    /// \returns the number of active touches.
+    std::size_t size() const
+    {
+        return CAPACITY - _numFree;
+    }
+
+    bool empty() const
+    {
+        return _numFree == CAPACITY;
+    }
+
+private:
+    enum
+    {
+        /// \brief The number of index entries, a power of two at least twice
+        /// the capacity to keep probe sequences short.
+        INDEX_SIZE = 256,
+        INDEX_MASK = INDEX_SIZE - 1,
+        EMPTY = 0xFF
+    };
+
+    static std::size_t hash(int touchId);
+
+    /// \returns the index entry holding the touch, or the empty entry where
+    /// it would be inserted.
+    std::size_t probe(int touchId) const;
+
+    /// \brief Maps each touch id to a slot, or EMPTY.
+    uint8_t _index[INDEX_SIZE];
+
+    ofTouchEventArgs _touches[CAPACITY];
+    glm::vec2 _predicted[CAPACITY];
+    bool _occupied[CAPACITY];
+
+    /// \brief A stack of unused slots, with the lowest slot on top.
+    uint8_t _free[CAPACITY];
+    std::size_t _numFree = CAPACITY;
+
+};
+
+
+} // ofx
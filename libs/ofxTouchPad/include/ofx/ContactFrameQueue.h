@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "ofx/TouchBuffer.h"
+
+
+namespace ofx {
+
+
+/// \brief A bounded, lock-free queue of ContactFrames.
+///
+/// The queue hands converted frames from any number of producers (the
+/// driver callback threads, the input thread, and threads that disconnect
+/// devices) to a single consumer (usually the oF update thread). Neither
+/// side allocates and the consumer never blocks. When the queue is full,
+/// the OverflowPolicy decides what is lost.
+///
+/// The ring uses per-slot sequence numbers. Producers claim slots with a
+/// CAS, which also lets a producer discard the oldest frame while the
+/// consumer is reading. Frames from each producer stay in order.
+class ContactFrameQueue
+{
+public:
+    enum OverflowPolicy
+    {
+        /// \brief Discard the oldest queued frame to make room.
+        DROP_OLDEST = 0,
+        /// \brief Merge new frames into a single overflow frame, replacing
+        /// consecutive moves of the same touch with the latest one.
+        ///
+        /// No frame is dropped. A producer that arrives while the overflow
+        /// frame is being written or read yields until it is done.
+        COALESCE_MOVES = 1
+    };
+
+    /// \brief Create a ContactFrameQueue.
+    /// \param capacity The minimum capacity, rounded up to a power of two.
+    ContactFrameQueue(std::size_t capacity = DEFAULT_CAPACITY);
+
+    ~ContactFrameQueue();
+
+    /// \brief Add a frame. Safe on any thread.
+    /// \param frame The frame to add.
+    /// \returns false if the frame was dropped.
+    bool push(const ContactFrame& frame);
+
+    /// \brief Remove the oldest frame. Consumer only.
+    /// \param frame The frame to fill.
+    /// \returns true if a frame was removed.
+    bool pop(ContactFrame& frame);
+
+    /// \returns the approximate number of queued frames.
+    std::size_t size() const;
+
+    /// \returns the capacity of the ring.
+    std::size_t capacity() const;
+
+    OverflowPolicy getOverflowPolicy() const;
+    void setOverflowPolicy(OverflowPolicy policy);
+
+    /// \returns the number of times a frame arrived while the ring was full.
+    uint64_t overflowCount() const;
+
+    /// \returns the number of frames that were lost.
+    uint64_t droppedFrameCount() const;
+
+    /// \returns the number of frames merged into the overflow frame.
+    uint64_t coalescedFrameCount() const;
+
+    /// \brief Merge a newer frame into an older one.
+    ///
+    /// Consecutive moves of the same touch are replaced by the newest one,
+    /// and the replaced positions are added to the older frame's history.
+    /// Down and up boundaries are always kept.
+    ///
+    /// \param older The frame to merge into.
+    /// \param newer The newer frame.
+    static void coalesce(ContactFrame& older, const ContactFrame& newer);
+
+    enum
+    {
+        DEFAULT_CAPACITY = 64
+    };
+
+private:
+    ContactFrameQueue(const ContactFrameQueue&);
+    ContactFrameQueue& operator=(const ContactFrameQueue&);
+
+    struct Slot
+    {
+        std::atomic<std::size_t> sequence;
+        ContactFrame frame;
+    };
+
+    enum OverflowState
+    {
+        OVERFLOW_EMPTY = 0,
+        OVERFLOW_WRITING,
+        OVERFLOW_READY,
+        OVERFLOW_READING
+    };
+
+    bool tryPush(const ContactFrame& frame);
+
+    /// \brief Add a frame, merging it into the overflow frame if needed.
+    bool pushCoalesced(const ContactFrame& frame);
+
+    /// \brief Remove the oldest frame from the ring.
+    /// \param frame The frame to fill, or nullptr to discard it.
+    bool tryPop(ContactFrame* frame);
+
+    /// \brief Append newer touches to older ones, coalescing moves.
+    /// \param older The touches to merge into.
+    /// \param newer The newer touches.
+    /// \param timestamp The timestamp of the older touches.
+    /// \param history Receives the positions of merged moves, or nullptr.
+    static void coalesce(TouchBuffer& older,
+                         const TouchBuffer& newer,
+                         double timestamp,
+                         TouchHistory* history);
+
+    std::vector<Slot> _slots;
+    std::size_t _mask;
+
+    alignas(64) std::atomic<std::size_t> _enqueuePosition;
+    alignas(64) std::atomic<std::size_t> _dequeuePosition;
+
+    /// \brief Frames that arrived while the ring was full (COALESCE_MOVES).
+    ContactFrame _overflowFrame;
+    std::atomic<int> _overflowState;
+
+    std::atomic<int> _overflowPolicy;
+    std::atomic<uint64_t> _overflowCount;
+    std::atomic<uint64_t> _droppedFrameCount;
+    std::atomic<uint64_t> _coalescedFrameCount;
+
+};
+
+
+} // ofx
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofJson.h"
+#include "ofx/SharedValue.h"
+#include "ofx/TouchFrame.h"
+
+
+namespace ofx {
+
+
+/// \brief The learned normalized position range of a single device.
+///
+/// The driver doesn't deliver normalized positions in the range 0-1 in all
+/// cases, so the range is extended with every frame and used to map
+/// positions back into 0-1. The bounds are published as one SharedValue, so
+/// the device's frame thread can extend them while other threads read or
+/// replace them, and every reader sees all four from the same update.
+class DeviceCalibration
+{
+public:
+    DeviceCalibration();
+
+    /// \brief Grow the bounds to include every position in the frame.
+    ///
+    /// Only takes a lock when the bounds grow, which stops soon after a
+    /// device is first used.
+    void extend(const TouchFrame& frame);
+
+    /// \brief Copy the bounds into a transform.
+    void apply(TouchFrameTransform& transform) const;
+
+    /// \brief Reset the bounds to 0-1.
+    void reset();
+
+    /// \brief Replace the bounds.
+    void set(float minX, float minY, float maxX, float maxY);
+
+    float minX() const;
+    float minY() const;
+    float maxX() const;
+    float maxY() const;
+
+    ofJson toJson() const;
+
+    /// \brief Replace the bounds with values from toJson().
+    /// \returns false if the json is not a valid calibration.
+    bool fromJson(const ofJson& json);
+
+private:
+    DeviceCalibration(const DeviceCalibration&);
+    DeviceCalibration& operator=(const DeviceCalibration&);
+
+    struct Bounds
+    {
+        float minX = 0;
+        float minY = 0;
+        float maxX = 1;
+        float maxY = 1;
+    };
+
+    SharedValue<Bounds> _bounds;
+
+};
+
+
+} // ofx
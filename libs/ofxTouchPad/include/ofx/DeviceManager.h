@@ -0,0 +1,228 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ofEvents.h"
+
+
+namespace ofx {
+
+
+/// \brief Describes a device that was added, removed, connected or
+/// disconnected.
+class DeviceEventArgs
+{
+public:
+    /// \brief The id of the device in its FrameSource.
+    int deviceId = -1;
+
+    /// \brief The identity of the device, the same every time it is found.
+    std::string identity;
+
+    /// \brief A human readable name for the device.
+    std::string name;
+
+    /// \brief True if the device was delivering frames.
+    bool isConnected = false;
+
+};
+
+
+/// \brief The device events.
+///
+/// The events fire on the update thread.
+class DeviceEvents
+{
+public:
+    /// \brief Fires when a device is plugged in, or found at startup.
+    ofEvent<const DeviceEventArgs> added;
+
+    /// \brief Fires when a device is unplugged.
+    ofEvent<const DeviceEventArgs> removed;
+
+    /// \brief Fires when a device starts delivering frames.
+    ofEvent<const DeviceEventArgs> connected;
+
+    /// \brief Fires when a device stops delivering frames.
+    ofEvent<const DeviceEventArgs> disconnected;
+
+};
+
+
+/// \brief Options for the device manager.
+class DeviceManagerSettings
+{
+public:
+    /// \brief True to look for devices that appear or disappear.
+    bool watch = true;
+
+    /// \brief The time between looks in seconds.
+    double pollInterval = 1.0;
+
+    /// \brief True to connect devices as soon as they are found.
+    bool autoConnect = true;
+
+    /// \brief The devices to connect when found, or empty for all of them.
+    std::vector<int> autoConnectDeviceIds;
+
+};
+
+
+/// \brief Watches for devices and connects them on a background thread.
+///
+/// The manager knows nothing about any particular backend. It calls a scan
+/// function that returns the present devices, diffs the result against the
+/// previous scan, and calls connect and disconnect functions for the
+/// devices that came and went. A device that was connected at the previous
+/// scan and is present but disconnected now was plugged back in between the
+/// scans, unless it was disconnected on purpose, and is reported as removed
+/// and added again. Requests to connect or disconnect are queued
+/// and carried out on the manager's thread, so slow driver calls never
+/// block the caller.
+///
+/// Events are queued with post() from any thread and fired by update() on
+/// the thread that calls it.
+class DeviceManager
+{
+public:
+    /// \returns the devices that are present.
+    typedef std::function<std::vector<DeviceEventArgs>()> ScanFunction;
+
+    /// \brief Connects or disconnects the device with the given id.
+    typedef std::function<void(int deviceId)> DeviceFunction;
+
+    enum EventType
+    {
+        DEVICE_ADDED,
+        DEVICE_REMOVED,
+        DEVICE_CONNECTED,
+        DEVICE_DISCONNECTED
+    };
+
+    DeviceManager();
+
+    ~DeviceManager();
+
+    /// \brief Start the manager's thread.
+    ///
+    /// The thread scans for devices at once. Every present device is new to
+    /// the first scan.
+    ///
+    /// \param settings The manager options.
+    /// \param scan The function that lists the present devices.
+    /// \param connect The function that connects a device.
+    /// \param disconnect The function that disconnects a device. It is also
+    /// called for devices that were removed.
+    /// \returns false if the thread is already running.
+    bool start(const DeviceManagerSettings& settings,
+               ScanFunction scan,
+               DeviceFunction connect,
+               DeviceFunction disconnect);
+
+    /// \brief Stop the thread. Queued requests that haven't started are
+    /// discarded.
+    void stop();
+
+    /// \returns true if the thread is running.
+    bool isRunning() const;
+
+    /// \returns the settings the thread was started with.
+    DeviceManagerSettings settings() const;
+
+    /// \brief Scan for devices as soon as possible.
+    void refresh();
+
+    /// \brief Queue a request to connect a device.
+    void connect(int deviceId);
+
+    /// \brief Queue a request to disconnect a device.
+    void disconnect(int deviceId);
+
+    /// \brief Tell the manager whether a device is meant to be connected.
+    ///
+    /// A device that is disconnected on purpose isn't mistaken for one that
+    /// was plugged back in between scans. Call it before the device is
+    /// connected or disconnected.
+    ///
+    /// \param deviceId The device id.
+    /// \param isWanted True if the device is being connected.
+    void setConnectionWanted(int deviceId, bool isWanted);
+
+    /// \returns the devices that were present at the last scan.
+    std::vector<DeviceEventArgs> devices() const;
+
+    /// \brief Queue an event. Can be called from any thread.
+    void post(EventType type, const DeviceEventArgs& args);
+
+    /// \brief Fire the queued events.
+    /// \param events The events to fire.
+    void update(DeviceEvents& events);
+
+private:
+    DeviceManager(const DeviceManager&);
+    DeviceManager& operator=(const DeviceManager&);
+
+    struct Command
+    {
+        bool isConnect;
+        int deviceId;
+    };
+
+    struct Event
+    {
+        EventType type;
+        DeviceEventArgs args;
+    };
+
+    void run();
+
+    /// \brief Diff the present devices against the previous scan.
+    void scan();
+
+    DeviceManagerSettings _settings;
+    ScanFunction _scan;
+    DeviceFunction _connect;
+    DeviceFunction _disconnect;
+
+    /// \brief The devices present at the last scan, sorted by id.
+    std::vector<DeviceEventArgs> _devices;
+
+    /// \brief The devices that were disconnected on purpose.
+    std::set<int> _unwantedDeviceIds;
+
+    std::vector<Command> _commands;
+
+    bool _isRefreshRequested = false;
+
+    std::vector<Event> _events;
+
+    /// \brief The events being fired by update().
+    std::vector<Event> _firingEvents;
+
+    std::thread _thread;
+    std::atomic<bool> _isRunning;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+
+    /// \brief Guards _events.
+    std::mutex _eventMutex;
+
+};
+
+
+} // ofx
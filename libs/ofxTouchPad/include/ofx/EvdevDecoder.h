@@ -0,0 +1,210 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+/// \brief A single Linux input event.
+///
+/// This mirrors struct input_event, with the time in seconds, so that event
+/// streams can be decoded on any platform.
+class EvdevEvent
+{
+public:
+    /// \brief The event time in seconds.
+    double timestamp = 0;
+
+    uint16_t type = 0;
+    uint16_t code = 0;
+    int32_t value = 0;
+
+};
+
+
+/// \brief The range of an absolute axis, as reported by EVIOCGABS.
+class EvdevAxis
+{
+public:
+    int32_t minimum = 0;
+    int32_t maximum = 0;
+
+    /// \brief Units per millimeter, or 0 if unknown.
+    int32_t resolution = 0;
+
+    /// \returns true if the axis has a range.
+    bool isValid() const
+    {
+        return maximum > minimum;
+    }
+
+};
+
+
+/// \brief Turns a multitouch protocol B event stream into contact frames.
+///
+/// Slot updates are collected until SYN_REPORT and then delivered as one
+/// frame of MTTouches, as if they came from the MultitouchSupport driver:
+///
+/// - A new tracking id in a slot makes a touch (MTTouchStateMakeTouch).
+/// - A slot that keeps its tracking id is touching (MTTouchStateTouching).
+/// - A released or reused slot ends its touch (MTTouchStateOutOfRange).
+///
+/// Path indices are the kernel tracking ids, so a slot that is reused for a
+/// new finger starts a new path. Normalized positions have their origin at
+/// the bottom left like the MultitouchSupport driver, and absolute positions
+/// and axes are in millimeters when the device reports a resolution.
+///
+/// After SYN_DROPPED, events are ignored up to the next SYN_REPORT. The
+/// caller should then restore the slot state (e.g. with EVIOCGMTSLOTS) by
+/// decoding synthetic events followed by a SYN_REPORT.
+class EvdevDecoder
+{
+public:
+    /// \brief The callback invoked once per SYN_REPORT.
+    ///
+    /// The touches are only valid for the duration of the call.
+    typedef std::function<void(const MTTouch* touches,
+                               int32_t numTouches,
+                               double timestamp,
+                               int32_t frameNum)> FrameCallback;
+
+    /// \brief Event types and codes from linux/input-event-codes.h.
+    enum
+    {
+        TYPE_SYN = 0x00,
+        TYPE_ABS = 0x03,
+
+        CODE_SYN_REPORT = 0x00,
+        CODE_SYN_DROPPED = 0x03,
+
+        CODE_MT_SLOT = 0x2f,
+        CODE_MT_TOUCH_MAJOR = 0x30,
+        CODE_MT_TOUCH_MINOR = 0x31,
+        CODE_MT_ORIENTATION = 0x34,
+        CODE_MT_POSITION_X = 0x35,
+        CODE_MT_POSITION_Y = 0x36,
+        CODE_MT_TRACKING_ID = 0x39,
+        CODE_MT_PRESSURE = 0x3a,
+
+        /// \brief The number of absolute axis codes.
+        ABS_COUNT = 0x40
+    };
+
+    enum
+    {
+        /// \brief The maximum number of slots that are decoded.
+        MAX_SLOTS = 32
+    };
+
+    EvdevDecoder();
+
+    /// \brief Set the range of an absolute axis.
+    /// \param code The axis code, e.g. CODE_MT_POSITION_X.
+    /// \param axis The range.
+    void setAxis(uint16_t code, const EvdevAxis& axis);
+
+    /// \returns the range of an absolute axis.
+    const EvdevAxis& axis(uint16_t code) const;
+
+    /// \brief Set the callback that receives frames.
+    void setFrameCallback(FrameCallback callback);
+
+    /// \brief Decode one event, delivering a frame on SYN_REPORT.
+    void decode(const EvdevEvent& event);
+
+    /// \brief Forget every contact without ending it.
+    void reset();
+
+private:
+    struct Slot
+    {
+        int32_t trackingId = -1;
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t touchMajor = 0;
+        int32_t touchMinor = 0;
+        int32_t orientation = 0;
+        int32_t pressure = 0;
+
+        /// \brief The tracking id in the last frame, or -1.
+        int32_t reportedId = -1;
+
+        /// \brief The touch in the last frame, used to end it.
+        MTTouch reported;
+    };
+
+    void report(double timestamp);
+
+    /// \brief Convert a slot to a touch.
+    MTTouch toTouch(const Slot& slot, MTTouchPhase phase, double timestamp) const;
+
+    /// \returns the normalized value of an axis (0-1).
+    float normalize(uint16_t code, int32_t value) const;
+
+    /// \returns the value of an axis in millimeters, or the raw value if
+    /// the axis has no resolution.
+    float millimeters(uint16_t code, int32_t value) const;
+
+    std::array<EvdevAxis, ABS_COUNT> _axes;
+    std::array<Slot, MAX_SLOTS> _slots;
+
+    /// \brief The slot being updated, or -1 if it is beyond MAX_SLOTS.
+    int _slot = 0;
+
+    /// \brief True between SYN_DROPPED and the next SYN_REPORT.
+    bool _isDropping = false;
+
+    int32_t _frameNum = 0;
+
+    /// \brief Room for an ended and a new touch in every slot.
+    std::array<MTTouch, MAX_SLOTS * 2> _touches;
+
+    FrameCallback _frameCallback;
+
+};
+
+
+/// \brief An input event stream recorded with evemu-record.
+///
+/// Only the absolute axis ranges ("A:" lines) and the events ("E:" lines)
+/// are read, so recordings from any multitouch device can be decoded
+/// without the device.
+class EvdevRecording
+{
+public:
+    /// \brief Load an evemu-record file.
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the file was loaded.
+    bool load(const std::string& path);
+
+    /// \brief Set the axis ranges of a decoder from the recording.
+    void configure(EvdevDecoder& decoder) const;
+
+    /// \brief The device name, if recorded.
+    std::string name;
+
+    /// \brief The recorded axis ranges, indexed by code.
+    std::vector<EvdevAxis> axes;
+
+    /// \brief The recorded events, in order.
+    std::vector<EvdevEvent> events;
+
+};
+
+
+} // ofx
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#if defined(__linux__)
+
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ofx/EvdevDecoder.h"
+#include "ofx/FrameSource.h"
+
+
+namespace ofx {
+
+
+/// \brief A FrameSource that reads Linux evdev multitouch devices.
+///
+/// Devices that speak multitouch protocol B (ABS_MT_SLOT with
+/// ABS_MT_POSITION_X/Y) are read with an epoll loop on a single thread.
+/// Each SYN_REPORT is delivered as one frame, so touchpads and touchscreens
+/// go through the same conversion and dispatch as the MultitouchSupport
+/// driver. The protocol is decoded by an EvdevDecoder, which can also be fed
+/// recorded event streams without any hardware.
+///
+/// Devices are identified by their unique id, or their physical location and
+/// name, so a device keeps its id when it is plugged back in under another
+/// device node.
+///
+/// Reading /dev/input/event* usually requires membership of the input group.
+class EvdevFrameSource: public FrameSource
+{
+public:
+    /// \brief Create an EvdevFrameSource.
+    /// \param devicePaths The device nodes to use, or empty to use every
+    /// multitouch device in /dev/input.
+    EvdevFrameSource(const std::vector<std::string>& devicePaths = std::vector<std::string>());
+
+    virtual ~EvdevFrameSource();
+
+    std::string name() const override;
+    void refreshDeviceList() override;
+    std::size_t numDevices() const override;
+    bool isPresent(int deviceId) const override;
+    std::string deviceIdentity(int deviceId) const override;
+    bool connect(int deviceId) override;
+    bool disconnect(int deviceId) override;
+    bool isConnected(int deviceId) const override;
+
+    /// \brief Event timestamps are requested from CLOCK_MONOTONIC, the clock
+    /// behind std::chrono::steady_clock on Linux. Events from devices that
+    /// refuse are stamped from the same clock as they are read.
+    bool hasSteadyTimestamps() const override;
+
+    /// \returns the device node of a device, e.g. /dev/input/event5.
+    std::string devicePath(int deviceId) const;
+
+    /// \returns the name reported by a device.
+    std::string deviceName(int deviceId) const override;
+
+private:
+    struct Device
+    {
+        std::string path;
+        std::string name;
+        std::string identity;
+        bool isPresent = false;
+
+        /// \brief The open device node, or -1 if not connected.
+        int fd = -1;
+
+        /// \brief True between SYN_DROPPED and the next SYN_REPORT.
+        bool isDropping = false;
+
+        /// \brief True if the kernel stamps events with CLOCK_MONOTONIC.
+        bool hasMonotonicTimestamps = true;
+
+        /// \brief Counts the connections, so the read thread can tell that a
+        /// device was reconnected while it dispatched a frame.
+        uint64_t connection = 0;
+
+        /// \brief True while the read thread decodes. Frames are then copied
+        /// to deferredFrame and dispatched once the lock is released.
+        bool isDeferring = false;
+
+        struct
+        {
+            std::array<MTTouch, EvdevDecoder::MAX_SLOTS * 2> touches;
+            int32_t numTouches = 0;
+            double timestamp = 0;
+            int32_t frameNum = 0;
+            bool isPending = false;
+        } deferredFrame;
+
+        EvdevDecoder decoder;
+    };
+
+    /// \brief Read the name, identity and axis ranges of an open device.
+    /// \returns false if it isn't a protocol B multitouch device.
+    static bool readDeviceInfo(int fd, Device& device);
+
+    /// \brief Decode the current slot state of a device, followed by a
+    /// SYN_REPORT. Used on connect and after the kernel dropped events.
+    static void resync(Device& device);
+
+    void startThread();
+    void stopThread();
+    void readThread();
+
+    /// \brief Read and decode all pending events of a device.
+    /// \returns false if the device was removed.
+    bool readEvents(int deviceId);
+
+    std::vector<std::string> _devicePaths;
+
+    std::vector<std::unique_ptr<Device>> _devices;
+
+    /// \brief Guards the devices against the read thread. The read thread
+    /// releases it before dispatching frames, so frame listeners may call into
+    /// the source while another thread holds a lock of its own and waits for
+    /// this one. Recursive because connect() dispatches the contacts that are
+    /// already down.
+    mutable std::recursive_mutex _mutex;
+
+    int _epollFd = -1;
+
+    /// \brief An eventfd that wakes the read thread to stop.
+    int _wakeFd = -1;
+
+    std::atomic<bool> _isRunning;
+    std::thread _thread;
+
+};
+
+
+} // ofx
+
+
+#endif // __linux__
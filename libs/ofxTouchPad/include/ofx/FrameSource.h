@@ -0,0 +1,279 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofRectangle.h"
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+class DeviceInfo
+{
+public:
+    DeviceInfo(MTDeviceRef _ref, int _id, const ofRectangle& _rect):
+        ref(_ref),
+        id(_id),
+        rect(_rect)
+    {
+    }
+
+    ~DeviceInfo()
+    {
+    }
+
+    MTDeviceRef ref;
+    int id;
+    ofRectangle rect;
+};
+
+
+/// \brief A read-only view of a raw contact frame, as the driver delivered
+/// it.
+///
+/// The touches are not copied. They are only valid for the duration of the
+/// event that delivers the view.
+class RawFrame
+{
+public:
+    /// \brief The id of the device that produced the frame.
+    int deviceId = -1;
+
+    /// \brief The driver's touches.
+    const MTTouch* touches = nullptr;
+
+    /// \brief The number of touches.
+    int32_t numTouches = 0;
+
+    /// \brief The driver timestamp of the frame in seconds.
+    double timestamp = 0;
+
+    /// \brief The driver frame number.
+    int32_t frameNum = 0;
+
+    std::size_t size() const
+    {
+        return numTouches > 0 ? numTouches : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    const MTTouch& operator [] (std::size_t i) const
+    {
+        return touches[i];
+    }
+
+    const MTTouch* begin() const
+    {
+        return touches;
+    }
+
+    const MTTouch* end() const
+    {
+        return touches + size();
+    }
+
+};
+
+
+/// \brief An abstract source of raw MTTouch contact frames.
+///
+/// A FrameSource owns the connection to one or more multitouch devices and
+/// delivers each contact frame to its frame callback. The TouchPad installs
+/// the callback, so every source feeds the same conversion and dispatch path.
+///
+/// Device ids are stable. Refreshing the device list keeps the id of every
+/// device that is found again, matched by its identity, and appends new
+/// devices. Devices that are gone stay in the list but are no longer present.
+///
+/// refreshDeviceList(), connect() and disconnect() are never called
+/// concurrently, but frames may arrive during any of them.
+class FrameSource
+{
+public:
+    /// \brief The callback invoked once per contact frame.
+    ///
+    /// The touches are only valid for the duration of the call.
+    typedef std::function<void(int deviceId,
+                               const MTTouch* touches,
+                               int32_t numTouches,
+                               double timestamp,
+                               int32_t frameNum)> FrameCallback;
+
+    virtual ~FrameSource()
+    {
+    }
+
+    /// \returns a short human readable name for this source.
+    virtual std::string name() const = 0;
+
+    /// \brief Enumerate the devices available to this source.
+    virtual void refreshDeviceList() = 0;
+
+    /// \returns the number of devices this source has found, including
+    /// devices that are no longer present.
+    virtual std::size_t numDevices() const = 0;
+
+    /// \returns true if the device was present at the last refresh.
+    virtual bool isPresent(int deviceId) const
+    {
+        return deviceId >= 0 && deviceId < static_cast<int>(numDevices());
+    }
+
+    /// \returns an identity that is the same every time the device is found,
+    /// e.g. its GUID or serial number.
+    virtual std::string deviceIdentity(int deviceId) const
+    {
+        return name() + ":" + std::to_string(deviceId);
+    }
+
+    /// \returns a human readable name for the device.
+    virtual std::string deviceName(int deviceId) const
+    {
+        return name() + " " + std::to_string(deviceId);
+    }
+
+    /// \brief Start delivering frames from the given device.
+    /// \returns true if the device was connected.
+    virtual bool connect(int deviceId) = 0;
+
+    /// \brief Stop delivering frames from the given device.
+    /// \returns true if the device was disconnected.
+    virtual bool disconnect(int deviceId) = 0;
+
+    /// \returns true if the given device is connected.
+    virtual bool isConnected(int deviceId) const = 0;
+
+    /// \returns true if frame timestamps are seconds of
+    /// std::chrono::steady_clock, so they can be compared with the time a
+    /// frame is dispatched.
+    virtual bool hasSteadyTimestamps() const
+    {
+        return false;
+    }
+
+    /// \brief Set the callback that receives frames.
+    ///
+    /// This must be set before any device is connected.
+    void setFrameCallback(FrameCallback callback)
+    {
+        _frameCallback = callback;
+    }
+
+protected:
+    /// \brief Deliver a frame to the frame callback.
+    void notifyFrame(int deviceId,
+                     const MTTouch* touches,
+                     int32_t numTouches,
+                     double timestamp,
+                     int32_t frameNum) const
+    {
+        if (_frameCallback)
+        {
+            _frameCallback(deviceId, touches, numTouches, timestamp, frameNum);
+        }
+    }
+
+private:
+    FrameCallback _frameCallback;
+
+};
+
+
+/// \brief An in-process FrameSource driven by the application.
+///
+/// Frames pushed with pushFrame() are delivered synchronously on the calling
+/// thread. This allows the TouchPad pipeline to be exercised without any
+/// multitouch hardware, e.g. for benchmarks or on platforms without the
+/// MultitouchSupport framework.
+///
+/// Virtual devices can be plugged and unplugged with addDevice() and
+/// removeDevice() to exercise hot-plugging.
+class SyntheticFrameSource: public FrameSource
+{
+public:
+    /// \brief Create a SyntheticFrameSource.
+    /// \param numDevices The number of virtual devices to expose.
+    SyntheticFrameSource(std::size_t numDevices = 1);
+
+    virtual ~SyntheticFrameSource();
+
+    std::string name() const override;
+    void refreshDeviceList() override;
+    std::size_t numDevices() const override;
+    bool isPresent(int deviceId) const override;
+    std::string deviceIdentity(int deviceId) const override;
+    bool connect(int deviceId) override;
+    bool disconnect(int deviceId) override;
+    bool isConnected(int deviceId) const override;
+
+    /// \brief Plug in a virtual device.
+    ///
+    /// A device with the identity of an unplugged device gets its old id
+    /// back.
+    ///
+    /// \param identity The device identity, or empty for a new device.
+    /// \returns the device id, or -1 if there are MAX_DEVICES devices.
+    int addDevice(const std::string& identity = "");
+
+    /// \brief Unplug a virtual device. It stops delivering frames at once.
+    /// \returns false if the device isn't present.
+    bool removeDevice(int deviceId);
+
+    /// \brief Deliver a frame as if it came from the given device.
+    ///
+    /// Frames for devices that are not connected or not present are ignored.
+    ///
+    /// \returns true if the frame was delivered.
+    bool pushFrame(int deviceId,
+                   const MTTouch* touches,
+                   int32_t numTouches,
+                   double timestamp,
+                   int32_t frameNum);
+
+    /// \brief Make a touch with the given normalized position.
+    /// \param pathIndex The path index (touch id) of the touch.
+    /// \param phase The touch phase.
+    /// \param x The normalized x position (0-1).
+    /// \param y The normalized y position (0-1).
+    /// \returns the touch.
+    static MTTouch makeTouch(int32_t pathIndex,
+                             MTTouchPhase phase,
+                             float x,
+                             float y);
+
+    enum
+    {
+        MAX_DEVICES = 64
+    };
+
+private:
+    mutable std::mutex _mutex;
+
+    std::vector<std::string> _identities;
+
+    /// \brief Bits of the present and connected devices, read without
+    /// locking by pushFrame().
+    std::atomic<uint64_t> _present;
+    std::atomic<uint64_t> _connected;
+
+};
+
+
+} // ofx
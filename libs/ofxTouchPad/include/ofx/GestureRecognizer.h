@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofEvents.h"
+#include "ofx/TouchBuffer.h"
+
+
+namespace ofx {
+
+
+class GestureEventArgs: public ofEventArgs
+{
+public:
+    enum Type
+    {
+        /// \brief One or more touches moving together.
+        PAN = 0,
+        /// \brief Two or more touches moving apart or together.
+        PINCH = 1,
+        /// \brief Two or more touches turning around their centroid.
+        ROTATE = 2,
+        /// \brief A pan that ended at speed. Swipes only have an ENDED phase.
+        SWIPE = 3
+    };
+
+    enum Phase
+    {
+        BEGAN = 0,
+        CHANGED = 1,
+        ENDED = 2
+    };
+
+    Type type = PAN;
+    Phase phase = BEGAN;
+
+    /// \brief The id of the device that produced the gesture.
+    int deviceId = 0;
+
+    /// \brief The number of touches taking part in the gesture.
+    std::size_t numTouches = 0;
+
+    /// \brief The driver timestamp of the latest frame in seconds.
+    double timestamp = 0;
+
+    /// \brief The centroid of the touches.
+    glm::vec2 centroid;
+
+    /// \brief The movement of the centroid since the gesture started.
+    glm::vec2 translation;
+
+    /// \brief The movement of the centroid since the previous frame.
+    glm::vec2 delta;
+
+    /// \brief The smoothed velocity of the centroid, in units per second.
+    glm::vec2 velocity;
+
+    /// \brief The spread of the touches relative to when the gesture started.
+    float scale = 1;
+
+    /// \brief The rotation in radians since the gesture started.
+    ///
+    /// Positive values turn from the x axis towards the y axis, which is
+    /// clockwise on screen.
+    float rotation = 0;
+
+};
+
+
+/// \brief The events fired by GestureRecognizers.
+class GestureEvents
+{
+public:
+    ofEvent<GestureEventArgs> pan;
+    ofEvent<GestureEventArgs> pinch;
+    ofEvent<GestureEventArgs> rotate;
+    ofEvent<GestureEventArgs> swipe;
+
+};
+
+
+/// \brief Thresholds for recognizing gestures.
+///
+/// Distances and velocities are in the units of the current
+/// TouchPad::ScalingMode, so the defaults suit window or rectangle scaling.
+class GestureSettings
+{
+public:
+    /// \brief The centroid movement that begins a pan.
+    float panThreshold = 10;
+
+    /// \brief The relative change in spread that begins a pinch.
+    float pinchThreshold = 0.1f;
+
+    /// \brief The rotation in radians that begins a rotate.
+    float rotateThreshold = 0.15f;
+
+    /// \brief The minimum centroid speed, in units per second, when every
+    /// touch lifts for the gesture to count as a swipe.
+    float swipeVelocity = 1000;
+
+    /// \brief The weight of the newest sample in the velocity average (0-1].
+    float velocitySmoothing = 0.5f;
+
+};
+
+
+/// \brief Recognizes pan, pinch, rotate and swipe gestures for one device.
+///
+/// The recognizer consumes each contact frame once. It keeps a running
+/// centroid, spread and rotation, so every frame costs O(n) in the number of
+/// touches. Whenever a touch goes down, up or is cancelled, active gestures
+/// end and the baseline is taken again from the new set of touches. A swipe
+/// is only reported when the last touches lift, not when fingers are added
+/// or removed mid-gesture or touches are cancelled.
+class GestureRecognizer
+{
+public:
+    GestureRecognizer();
+
+    /// \brief Process the touches of one contact frame.
+    /// \param deviceId The device whose touches should be used; touches from
+    ///        other devices are ignored.
+    /// \param touches The touches of the frame.
+    /// \param timestamp The driver timestamp of the frame in seconds.
+    /// \param settings The recognition thresholds.
+    /// \param events The events to notify.
+    void process(int deviceId,
+                 const TouchBuffer& touches,
+                 double timestamp,
+                 const GestureSettings& settings,
+                 GestureEvents& events);
+
+    /// \brief End all gestures without notifying and forget the baseline.
+    void reset();
+
+private:
+    enum
+    {
+        /// \brief The size of the per-touch angle table, a power of two.
+        ANGLE_TABLE_SIZE = 64
+    };
+
+    /// \brief The angle of one touch around the centroid in the last frame.
+    struct TouchAngle
+    {
+        int id = -1;
+        float angle = 0;
+    };
+
+    void begin(const glm::vec2& centroid, float spread, std::size_t numTouches, double timestamp);
+    /// \brief End the active gestures.
+    /// \param isLifted True if every touch lifted, which may end in a swipe.
+    void end(const GestureSettings& settings, GestureEvents& events, bool isLifted);
+
+    void notify(ofEvent<GestureEventArgs>& event,
+                GestureEventArgs::Type type,
+                GestureEventArgs::Phase phase);
+
+    GestureEventArgs _args;
+
+    bool _isTracking = false;
+    bool _isPanning = false;
+    bool _isPinching = false;
+    bool _isRotating = false;
+
+    glm::vec2 _startCentroid;
+    float _startSpread = 0;
+
+    TouchAngle _angles[ANGLE_TABLE_SIZE];
+
+};
+
+
+} // ofx
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+/// \brief Options for the input thread.
+class InputThreadSettings
+{
+public:
+    /// \brief The scheduling priority, or 0 to keep the default.
+    ///
+    /// On Linux, 1-99 requests SCHED_FIFO real-time scheduling at that
+    /// priority, which needs CAP_SYS_NICE or an rtprio limit. On OSX, any
+    /// value above 0 requests the user-interactive QoS class.
+    int priority = 0;
+
+    /// \brief The CPU to pin the thread to, or -1 for any. Linux only.
+    int cpu = -1;
+
+    /// \brief The size of the frame ring in bytes.
+    std::size_t bufferSize = 1 << 18;
+
+};
+
+
+/// \brief Runs raw contact frames through a callback on a dedicated thread.
+///
+/// push() copies a raw frame into a lock-free byte ring and returns. It never
+/// waits for the frame to be processed, so the driver callback takes the
+/// same short time no matter what listeners do. The thread sleeps while the
+/// ring is empty; only then does push() take a lock, to wake it.
+///
+/// Several driver threads may push. They are serialized with a spin lock
+/// that only covers the copy, and the thread never takes it.
+///
+/// If the thread falls behind and the ring is full, frames are dropped and
+/// counted. Every driver frame lists all of its device's contacts, so the
+/// next frame that gets through restores the touch state.
+class InputThread
+{
+public:
+    /// \brief The callback invoked on the thread for every frame.
+    ///
+    /// The arguments are those of FrameSource::FrameCallback, and the time
+    /// the frame was pushed.
+    typedef std::function<void(int deviceId,
+                               const MTTouch* touches,
+                               int32_t numTouches,
+                               double timestamp,
+                               int32_t frameNum,
+                               std::chrono::steady_clock::time_point receivedTime)> FrameCallback;
+
+    InputThread();
+
+    ~InputThread();
+
+    /// \brief Start the thread.
+    ///
+    /// Frames left over from an earlier run are discarded.
+    ///
+    /// \param settings The thread options.
+    /// \param callback The callback that processes frames.
+    /// \returns false if the thread is already running.
+    bool start(const InputThreadSettings& settings, FrameCallback callback);
+
+    /// \brief Process the queued frames and stop the thread.
+    void stop();
+
+    /// \returns true if the thread is running.
+    bool isRunning() const;
+
+    /// \returns true if called from the thread.
+    bool isInputThread() const;
+
+    /// \returns the settings the thread was started with.
+    InputThreadSettings settings() const;
+
+    /// \brief Queue a raw frame. Safe on any thread.
+    /// \returns false if the frame was dropped.
+    bool push(int deviceId,
+              const MTTouch* touches,
+              int32_t numTouches,
+              double timestamp,
+              int32_t frameNum);
+
+    /// \brief Wait until every frame queued so far has been processed.
+    ///
+    /// Returns at once if the thread isn't running or if called from the
+    /// thread itself.
+    void flush();
+
+    /// \returns the number of frames waiting to be processed.
+    std::size_t size() const;
+
+    /// \returns the number of frames processed.
+    uint64_t processedFrameCount() const;
+
+    /// \returns the number of frames dropped because the ring was full.
+    uint64_t droppedFrameCount() const;
+
+private:
+    InputThread(const InputThread&);
+    InputThread& operator=(const InputThread&);
+
+    struct FrameHeader
+    {
+        int32_t deviceId;
+        int32_t numTouches;
+        double timestamp;
+        int32_t frameNum;
+        int32_t reserved;
+        std::chrono::steady_clock::time_point receivedTime;
+    };
+
+    /// \brief Apply the priority and affinity to the calling thread.
+    void applySettings();
+
+    void run();
+
+    /// \brief Process the oldest frame, if any.
+    /// \returns false if the ring was empty.
+    bool processFrame();
+
+    bool isEmpty() const;
+
+    void write(const void* data, std::size_t size, std::size_t position);
+    void read(void* data, std::size_t size, std::size_t position) const;
+
+    InputThreadSettings _settings;
+    FrameCallback _callback;
+
+    std::vector<uint8_t> _buffer;
+
+    alignas(64) std::atomic<std::size_t> _writePosition;
+
+    /// \brief Held by the thread that is pushing.
+    std::atomic<bool> _isPushing;
+
+    alignas(64) std::atomic<std::size_t> _readPosition;
+
+    /// \brief The touches of the frame being processed.
+    std::vector<MTTouch> _touches;
+
+    std::thread _thread;
+    std::atomic<bool> _isRunning;
+
+    /// \brief True while the thread waits for frames.
+    std::atomic<bool> _isWaiting;
+
+    mutable std::mutex _mutex;
+
+    /// \brief Wakes the thread.
+    std::condition_variable _frameCondition;
+
+    /// \brief Wakes flush() as frames are processed.
+    std::condition_variable _idleCondition;
+
+    /// \brief The number of threads waiting in flush().
+    std::atomic<int> _flushCount;
+
+    std::atomic<uint64_t> _pushedFrameCount;
+    std::atomic<uint64_t> _processedFrameCount;
+    std::atomic<uint64_t> _droppedFrameCount;
+
+};
+
+
+} // ofx
@@ -49,9 +49,13 @@
 
 #pragma once
 
+#include <stdint.h>
+
+#if defined(__APPLE__)
 #include <mach/mach.h> 
 #include <IOKit/IOKitLib.h> 
 #include <CoreFoundation/CoreFoundation.h> 
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -109,7 +113,13 @@ extern "C" {
         float    zDensity;		   // "ZDen" (~density)
     } MTTouch;
     
+#if defined(__APPLE__)
     typedef CFTypeRef MTDeviceRef;
+#else
+    // Other platforms only use the contact frame types (e.g. for synthetic or
+    // recorded frames), so an opaque pointer is enough.
+    typedef const void* MTDeviceRef;
+#endif
     
     typedef void (*MTContactCallbackFunction)(MTDeviceRef deviceId,
                                               MTTouch* touches,
@@ -117,6 +127,7 @@ extern "C" {
                                               double timestamp,
                                               int32_t frameNum);
     
+#if defined(__APPLE__)
 //    typedef int32_t (*MTRegisterImageCallbackFunction)(void);
     
     double      MTAbsoluteTimeGetCurrent();
@@ -162,6 +173,7 @@ extern "C" {
 
     bool MTDeviceSupportsActuation(MTDeviceRef deviceId);
     bool MTDeviceSupportsForce(MTDeviceRef deviceId);
+#endif // __APPLE__
 
         
 #ifdef __cplusplus
@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+// Based on code from https://github.com/calftrail/TrackMagic (GPL v2.0)
+// Based on code from Jens Alexander Ewald http://www.520at.net
+// Based on code from Steike http://steike.com/code/multitouch
+
+////////////////////////////////////////////////////////////////////////////////
+// IMPORTANT!
+// You must include the MultitouchSupport.framework from:
+// /System/Library/PrivateFrameworks/MultitouchSupport.framework
+// in order to compile.
+////////////////////////////////////////////////////////////////////////////////
+
+
+#pragma once
+
+
+#if defined(__APPLE__)
+
+
+#if (MAC_OS_X_VERSION_MAX_ALLOWED < MAC_OS_X_VERSION_10_5)
+    #error -- This needs OS X 10.5 (Leopard) or higher!\n \
+        \t\tCheck your current SDK settings and add the \
+        \t\/tMultitouchSupport.framework from the PrivateFrameworks folder
+#endif
+
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "ofx/FrameSource.h"
+
+
+namespace ofx {
+
+
+/// \brief A FrameSource backed by the MultitouchSupport framework.
+///
+/// Only a single instance may exist at a time, because the framework
+/// callback does not carry any user data.
+///
+/// Devices are identified by their GUID, or their device ID if the GUID is
+/// unavailable, so a trackpad that is unplugged and plugged back in keeps
+/// its device id.
+class MultitouchSupportFrameSource: public FrameSource
+{
+public:
+    MultitouchSupportFrameSource();
+    virtual ~MultitouchSupportFrameSource();
+
+    std::string name() const override;
+    void refreshDeviceList() override;
+    std::size_t numDevices() const override;
+    bool isPresent(int deviceId) const override;
+    std::string deviceIdentity(int deviceId) const override;
+    std::string deviceName(int deviceId) const override;
+    bool connect(int deviceId) override;
+    bool disconnect(int deviceId) override;
+    bool isConnected(int deviceId) const override;
+
+    /// \brief Driver timestamps are seconds of mach_absolute_time(), the
+    /// clock behind std::chrono::steady_clock on OSX.
+    bool hasSteadyTimestamps() const override;
+
+    static void printDeviceInfo(MTDeviceRef d);
+
+    /// \returns the GUID or device ID of a device, or an empty string.
+    static std::string identity(MTDeviceRef deviceRef);
+
+private:
+    /// \brief A device found by refreshDeviceList().
+    struct Device
+    {
+        /// \brief The latest reference to the device, retained.
+        MTDeviceRef ref = nullptr;
+
+        std::string identity;
+        std::string name;
+        bool isPresent = false;
+    };
+
+    typedef std::map<int, DeviceInfo*> DeviceMap;
+
+    enum
+    {
+        /// \brief The size of the device lookup table, a power of two.
+        DEVICE_TABLE_SIZE = 32
+    };
+
+    /// \brief An entry in the lock-free MTDeviceRef to DeviceInfo table.
+    struct DeviceTableEntry
+    {
+        std::atomic<MTDeviceRef> ref{nullptr};
+        std::atomic<DeviceInfo*> info{nullptr};
+    };
+
+    /// \brief Find a connected device in constant time.
+    ///
+    /// This is safe to call from the callback thread while devices are
+    /// connected and disconnected.
+    ///
+    /// \returns the device, or nullptr if it isn't connected.
+    DeviceInfo* findDevice(MTDeviceRef deviceRef) const;
+
+    /// \brief Set the table entry for a device reference.
+    ///
+    /// A new reference takes the first cleared entry on its probe path, so
+    /// the table never fills with disconnected devices.
+    void setDevice(MTDeviceRef deviceRef, DeviceInfo* info);
+
+    /// \brief Delete the disconnected devices if no callback is running.
+    void deleteRetiredDevices();
+
+    /// \brief Stop a connected device and retire its info.
+    ///
+    /// Must be called with _mutex held.
+    void stopDevice(DeviceMap::iterator iter);
+
+    static std::size_t hash(MTDeviceRef deviceRef);
+
+    MultitouchSupportFrameSource(const MultitouchSupportFrameSource&);
+    MultitouchSupportFrameSource& operator=(const MultitouchSupportFrameSource&);
+
+    static void mt_callback(MTDeviceRef deviceId,
+                            MTTouch* touches,
+                            int32_t numTouches,
+                            double timestamp,
+                            int32_t frameNum);
+
+    /// \brief Every device found, indexed by device id.
+    std::vector<Device> _deviceList;
+
+    /// \brief The connected devices.
+    DeviceMap _devices;
+
+    /// \brief Guards the device list and map against concurrent queries.
+    mutable std::mutex _mutex;
+
+    /// \brief Open-addressed table keyed by MTDeviceRef. Entries are never
+    /// removed, only cleared, so probe paths stay intact. Cleared entries are
+    /// reused for new references.
+    std::array<DeviceTableEntry, DEVICE_TABLE_SIZE> _deviceTable;
+
+    /// \brief The number of callbacks that are running.
+    std::atomic<int> _activeCallbacks{0};
+
+    /// \brief Disconnected devices, kept until no callback that may have
+    /// found them is still running.
+    std::vector<DeviceInfo*> _retiredDevices;
+
+    static MultitouchSupportFrameSource* _instance;
+
+};
+
+
+} // ofx
+
+
+#endif // __APPLE__
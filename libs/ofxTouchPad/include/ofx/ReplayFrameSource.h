@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ofx/FrameSource.h"
+#include "ofx/TouchRecording.h"
+
+
+namespace ofx {
+
+
+/// \brief A FrameSource that replays a TouchRecorder recording.
+///
+/// The recording is memory-mapped and indexed by timestamp when it is
+/// loaded. Frames are delivered straight from the mapping, without copying,
+/// either from a playback thread (play()) or synchronously (step()).
+///
+/// The recording must be loaded before the source is installed with
+/// TouchPad::setFrameSource(), so that the number of devices is known.
+class ReplayFrameSource: public FrameSource
+{
+public:
+    enum PlaybackMode
+    {
+        /// \brief Deliver frames at the recorded rate.
+        PLAYBACK_REAL_TIME = 0,
+        /// \brief Deliver frames at the recorded rate multiplied by the rate.
+        PLAYBACK_SCALED = 1,
+        /// \brief Deliver frames as fast as possible.
+        PLAYBACK_AS_FAST_AS_POSSIBLE = 2
+    };
+
+    ReplayFrameSource();
+
+    /// \brief Create a ReplayFrameSource and load a recording.
+    /// \param path The path, relative to the data folder.
+    ReplayFrameSource(const std::string& path);
+
+    virtual ~ReplayFrameSource();
+
+    /// \brief Map and index a recording.
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the recording is valid.
+    bool load(const std::string& path);
+
+    /// \brief Stop playback and unmap the recording.
+    void unload();
+
+    /// \returns true if a recording is loaded.
+    bool isLoaded() const;
+
+    std::string name() const override;
+    void refreshDeviceList() override;
+    std::size_t numDevices() const override;
+    bool connect(int deviceId) override;
+    bool disconnect(int deviceId) override;
+    bool isConnected(int deviceId) const override;
+
+    /// \brief Start delivering frames from the playback thread.
+    void play();
+
+    /// \brief Stop the playback thread, keeping the position.
+    void pause();
+
+    /// \brief Stop the playback thread and rewind.
+    void stop();
+
+    /// \returns true if the playback thread is running.
+    bool isPlaying() const;
+
+    /// \brief Deliver the next frame on the calling thread.
+    /// \returns false at the end of the recording.
+    bool step();
+
+    /// \brief Move to the first frame at or after the given time.
+    ///
+    /// This is a binary search of the timestamp index.
+    ///
+    /// \param time The time in seconds since the first frame.
+    void seek(double time);
+
+    /// \returns the time in seconds of the next frame since the first frame.
+    double position() const;
+
+    /// \returns the time in seconds between the first and last frame.
+    double duration() const;
+
+    /// \returns the number of frames in the recording.
+    std::size_t frameCount() const;
+
+    PlaybackMode getPlaybackMode() const;
+    void setPlaybackMode(PlaybackMode mode);
+
+    /// \returns the playback rate used by PLAYBACK_SCALED.
+    double getRate() const;
+
+    /// \param rate The playback rate used by PLAYBACK_SCALED, e.g. 2 for
+    ///        double speed.
+    void setRate(double rate);
+
+    bool isLooping() const;
+    void setLooping(bool looping);
+
+    enum
+    {
+        /// \brief The maximum number of devices in a recording.
+        MAX_DEVICES = 64
+    };
+
+private:
+    ReplayFrameSource(const ReplayFrameSource&);
+    ReplayFrameSource& operator=(const ReplayFrameSource&);
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct IndexEntry
+    {
+        double timestamp;
+        std::size_t offset;
+    };
+
+    bool buildIndex();
+
+    /// \brief Restart the playback clock at the current position.
+    void resetClock();
+
+    void deliver(std::size_t position) const;
+    void playbackThread();
+
+    double effectiveRate() const;
+
+    const uint8_t* _data = nullptr;
+    std::size_t _size = 0;
+
+    /// \brief Owns the data when memory mapping is unavailable.
+    std::vector<uint8_t> _fallbackData;
+
+    std::vector<IndexEntry> _index;
+    std::size_t _numDevices = 0;
+
+    std::atomic<uint64_t> _connectedDevices;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+
+    std::size_t _position = 0;
+    bool _isPlaying = false;
+    bool _clockReset = false;
+    Clock::time_point _clockStart;
+    double _clockTimestamp = 0;
+
+    PlaybackMode _playbackMode = PLAYBACK_REAL_TIME;
+    double _rate = 1;
+    bool _isLooping = false;
+
+};
+
+
+} // ofx
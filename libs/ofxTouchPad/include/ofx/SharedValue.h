@@ -0,0 +1,126 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+
+namespace ofx {
+
+
+/// \brief A value shared between one or more writers and any number of
+/// readers without blocking the readers.
+///
+/// The value is stored as atomic words guarded by a sequence number. Readers
+/// retry if a write was in progress, so load() never takes a lock and never
+/// waits for a thread that is busy with something else.
+template<typename T>
+class SharedValue
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value, "SharedValue requires a trivially copyable type.");
+
+    SharedValue(const T& value = T()):
+        _sequence(0)
+    {
+        write(value);
+    }
+
+    /// \returns the latest value. Safe on any thread.
+    T load() const
+    {
+        uint64_t words[NUM_WORDS];
+        uint32_t before = 0;
+        uint32_t after = 0;
+
+        do
+        {
+            before = _sequence.load(std::memory_order_acquire);
+
+            for (std::size_t i = 0; i < NUM_WORDS; ++i)
+            {
+                words[i] = _words[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = _sequence.load(std::memory_order_relaxed);
+        }
+        // An odd sequence means a write is in progress.
+        while (before != after || (before & 1) != 0);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /// \brief Replace the value. Writers are serialized with each other but
+    /// never block readers.
+    void store(const T& value)
+    {
+        std::unique_lock<std::mutex> lock(_writeMutex);
+
+        _sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        write(value);
+
+        _sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    /// \brief Modify the value. The function is called with the latest
+    /// value under the writers' lock, so a concurrent store() is never lost.
+    /// \param function Modifies the value it is passed by reference.
+    template<typename Function>
+    void update(Function function)
+    {
+        std::unique_lock<std::mutex> lock(_writeMutex);
+
+        T value = load();
+        function(value);
+
+        _sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        write(value);
+
+        _sequence.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    SharedValue(const SharedValue&);
+    SharedValue& operator=(const SharedValue&);
+
+    enum
+    {
+        NUM_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t)
+    };
+
+    void write(const T& value)
+    {
+        uint64_t words[NUM_WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        for (std::size_t i = 0; i < NUM_WORDS; ++i)
+        {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    mutable std::atomic<uint32_t> _sequence;
+    std::atomic<uint64_t> _words[NUM_WORDS];
+    std::mutex _writeMutex;
+
+};
+
+
+} // ofx
@@ -0,0 +1,163 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include "ofEvents.h"
+#include "ofx/TouchBuffer.h"
+
+
+namespace ofx {
+
+
+class TapEventArgs: public ofEventArgs
+{
+public:
+    /// \brief The id of the device that was tapped.
+    int deviceId = 0;
+
+    /// \brief The id of the last touch to lift or, for a long press, the
+    /// first touch to go down.
+    int touchId = 0;
+
+    /// \brief The number of fingers in the tap or long press.
+    std::size_t numTouches = 0;
+
+    /// \brief The number of taps in a row, e.g. 2 for a double tap.
+    ///
+    /// A tap event is fired for each tap, so a triple tap fires three events
+    /// with counts 1, 2 and 3. The count is always 1 for a long press.
+    std::size_t tapCount = 0;
+
+    /// \brief The mean position at which the fingers went down.
+    glm::vec2 position;
+
+    /// \brief The driver timestamp of the frame that completed the gesture.
+    double timestamp = 0;
+
+};
+
+
+/// \brief The events fired by TapRecognizers.
+class TapEvents
+{
+public:
+    ofEvent<TapEventArgs> tap;
+    ofEvent<TapEventArgs> longPress;
+
+};
+
+
+/// \brief Thresholds for recognizing taps and long presses.
+///
+/// Times are in seconds of driver time. Distances are in the units of the
+/// current TouchPad::ScalingMode, so the defaults suit window or rectangle
+/// scaling.
+class TapSettings
+{
+public:
+    /// \brief The longest time from the first finger down to the last
+    /// finger up that counts as a tap.
+    double tapDuration = 0.3;
+
+    /// \brief The longest time from the end of one tap to the start of the
+    /// next for them to be counted together.
+    double multiTapInterval = 0.5;
+
+    /// \brief The furthest a finger may move and still tap.
+    float tapRadius = 20;
+
+    /// \brief The furthest apart consecutive taps may be to be counted
+    /// together.
+    float multiTapRadius = 40;
+
+    /// \brief The time the fingers must be held still for a long press.
+    double longPressDuration = 0.6;
+
+};
+
+
+/// \brief Recognizes N-tap, multi-finger tap and long-press gestures for one
+/// device.
+///
+/// A sequence starts when the first finger goes down and ends when the last
+/// one lifts. The sequence is a tap if no finger moved beyond the tap radius,
+/// no finger joined late and it was short enough. Timing uses the driver's
+/// timestamps, so recognition is unaffected by queueing or replay.
+///
+/// Touches are kept in a compact table holding only the fingers that are
+/// down.
+class TapRecognizer
+{
+public:
+    TapRecognizer();
+
+    /// \brief Process the touches of one contact frame.
+    /// \param deviceId The device whose touches should be used; touches from
+    ///        other devices are ignored.
+    /// \param touches The touches of the frame.
+    /// \param timestamp The driver timestamp of the frame in seconds.
+    /// \param settings The recognition thresholds.
+    /// \param events The events to notify.
+    void process(int deviceId,
+                 const TouchBuffer& touches,
+                 double timestamp,
+                 const TapSettings& settings,
+                 TapEvents& events);
+
+    /// \brief Forget all touches and previous taps.
+    void reset();
+
+private:
+    struct TouchState
+    {
+        int id = -1;
+        glm::vec2 start;
+    };
+
+    /// \returns the state of a touch that is down, or nullptr.
+    TouchState* find(int touchId);
+
+    /// \brief Remove a touch from the table, keeping it compact.
+    void remove(TouchState* state);
+
+    void finishSequence(int deviceId,
+                        int touchId,
+                        double timestamp,
+                        const TapSettings& settings,
+                        TapEvents& events);
+
+    /// \brief The fingers that are down.
+    TouchState _touches[TouchBuffer::CAPACITY];
+    std::size_t _numTouches = 0;
+
+    /// \brief True while the current sequence may still be a tap or long press.
+    bool _isCandidate = false;
+    bool _isLongPressed = false;
+    double _sequenceStart = 0;
+
+    /// \brief The most fingers down at once in the current sequence.
+    std::size_t _sequenceTouches = 0;
+
+    /// \brief The sum of the down positions in the current sequence, and the
+    /// number of downs in it, which can exceed _sequenceTouches when a finger
+    /// lifts and another goes down.
+    glm::vec2 _sequenceStartSum;
+    std::size_t _sequenceDowns = 0;
+
+    int _sequenceFirstId = -1;
+
+    std::size_t _tapCount = 0;
+    std::size_t _lastTapTouches = 0;
+    double _lastTapTime = 0;
+    glm::vec2 _lastTapPosition;
+
+};
+
+
+} // ofx
@@ -0,0 +1,290 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "ofEvents.h"
+
+
+namespace ofx {
+
+
+/// \brief A fixed capacity, reusable buffer of touches.
+///
+/// The storage is allocated once with the buffer, so filling and clearing it
+/// never touches the heap. This keeps the contact frame callback free of
+/// allocations.
+class TouchBuffer
+{
+public:
+    enum
+    {
+        /// \brief The maximum number of touches in a single buffer, enough for
+        /// the active touches of several devices.
+        ///
+        /// This is twice TouchFrame::CAPACITY, so that a frame that collects
+        /// touches from more than one device (a snapshot, or a frame merged
+        /// in the queue) has room for a few devices with every finger down.
+        CAPACITY = 128
+    };
+
+    TouchBuffer()
+    {
+    }
+
+    TouchBuffer(const TouchBuffer& other)
+    {
+        *this = other;
+    }
+
+    ~TouchBuffer()
+    {
+    }
+
+    /// \brief Copy only the touches in use rather than the whole storage.
+    TouchBuffer& operator = (const TouchBuffer& other)
+    {
+        std::copy(other.begin(), other.end(), _touches.begin());
+        std::copy(other._predicted.begin(), other._predicted.begin() + other._size, _predicted.begin());
+        _size = other._size;
+        return *this;
+    }
+
+    /// \brief Remove all touches, keeping the storage.
+    void clear()
+    {
+        _size = 0;
+    }
+
+    /// \brief Append a touch.
+    /// \param touch The touch to append.
+    /// \returns false if the buffer was full and the touch was not added.
+    bool push_back(const ofTouchEventArgs& touch)
+    {
+        return push_back(touch, touch);
+    }
+
+    /// \brief Append a touch and its predicted position.
+    /// \param touch The touch to append.
+    /// \param predicted The predicted position of the touch.
+    /// \returns false if the buffer was full and the touch was not added.
+    bool push_back(const ofTouchEventArgs& touch, const glm::vec2& predicted)
+    {
+        if (_size < CAPACITY)
+        {
+            _predicted[_size] = predicted;
+            _touches[_size++] = touch;
+            return true;
+        }
+
+        return false;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    bool full() const
+    {
+        return _size == CAPACITY;
+    }
+
+    ofTouchEventArgs& operator [] (std::size_t i)
+    {
+        return _touches[i];
+    }
+
+    const ofTouchEventArgs& operator [] (std::size_t i) const
+    {
+        return _touches[i];
+    }
+
+    /// \brief Get the predicted position of a touch.
+    ///
+    /// This is the touch position unless a prediction horizon is set with
+    /// TouchPad::setKinematicsSettings().
+    glm::vec2& predicted(std::size_t i)
+    {
+        return _predicted[i];
+    }
+
+    const glm::vec2& predicted(std::size_t i) const
+    {
+        return _predicted[i];
+    }
+
+    ofTouchEventArgs* begin()
+    {
+        return _touches.data();
+    }
+
+    ofTouchEventArgs* end()
+    {
+        return _touches.data() + _size;
+    }
+
+    const ofTouchEventArgs* begin() const
+    {
+        return _touches.data();
+    }
+
+    const ofTouchEventArgs* end() const
+    {
+        return _touches.data() + _size;
+    }
+
+private:
+    std::array<ofTouchEventArgs, CAPACITY> _touches;
+    std::array<glm::vec2, CAPACITY> _predicted;
+    std::size_t _size = 0;
+
+};
+
+
+/// \brief Earlier positions of touches whose moves were coalesced.
+///
+/// Like the TouchBuffer, the storage is fixed, so filling and copying it
+/// never touches the heap. Samples beyond the capacity are dropped.
+class TouchHistory
+{
+public:
+    enum
+    {
+        /// \brief The maximum number of samples in a single frame.
+        CAPACITY = 128
+    };
+
+    /// \brief A past position of a touch.
+    struct Sample
+    {
+        int id = 0;
+        float x = 0;
+        float y = 0;
+
+        /// \brief The driver timestamp of the position in seconds.
+        double timestamp = 0;
+    };
+
+    TouchHistory()
+    {
+    }
+
+    TouchHistory(const TouchHistory& other)
+    {
+        *this = other;
+    }
+
+    /// \brief Copy only the samples in use rather than the whole storage.
+    TouchHistory& operator = (const TouchHistory& other)
+    {
+        std::copy(other.begin(), other.end(), _samples.begin());
+        _size = other._size;
+        return *this;
+    }
+
+    void clear()
+    {
+        _size = 0;
+    }
+
+    /// \brief Append a sample.
+    /// \returns false if the history was full and the sample was not added.
+    bool push_back(const Sample& sample)
+    {
+        if (_size < CAPACITY)
+        {
+            _samples[_size++] = sample;
+            return true;
+        }
+
+        return false;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    const Sample& operator [] (std::size_t i) const
+    {
+        return _samples[i];
+    }
+
+    const Sample* begin() const
+    {
+        return _samples.data();
+    }
+
+    const Sample* end() const
+    {
+        return _samples.data() + _size;
+    }
+
+private:
+    std::array<Sample, CAPACITY> _samples;
+    std::size_t _size = 0;
+
+};
+
+
+/// \brief A single converted contact frame from one device.
+class ContactFrame
+{
+public:
+    /// \brief The id of the device that produced the frame.
+    ///
+    /// A frame coalesced by the ContactFrameQueue may hold touches from
+    /// several devices; each touch id also encodes its device id.
+    int deviceId = -1;
+
+    /// \brief The driver timestamp of the frame in seconds.
+    double timestamp = 0;
+
+    /// \brief The driver frame number.
+    int32_t frameNum = 0;
+
+    /// \brief When the frame callback received the frame.
+    std::chrono::steady_clock::time_point receivedTime;
+
+    /// \brief The converted touches in the frame.
+    TouchBuffer touches;
+
+    /// \brief The earlier positions of touches whose moves were merged into
+    /// this frame, oldest first.
+    ///
+    /// This is only filled when frames are coalesced, e.g. in
+    /// TouchPad::DISPATCH_COALESCED mode. Together with the touch itself, the
+    /// samples of a touch give its full path since the previous frame.
+    TouchHistory history;
+
+    /// \brief The fingers hovering in range of the device.
+    ///
+    /// The type is down on entering range, move while hovering and up on
+    /// leaving range.
+    TouchBuffer hovers;
+
+};
+
+
+} // ofx
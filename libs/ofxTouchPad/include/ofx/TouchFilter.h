@@ -0,0 +1,132 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include "ofx/TouchFrame.h"
+
+
+namespace ofx {
+
+
+/// \brief Options for smoothing touch positions.
+///
+/// Distances are in the units of the current TouchPad::ScalingMode and times
+/// are in seconds of driver time.
+class FilterSettings
+{
+public:
+    enum Filter
+    {
+        /// \brief Leave positions untouched.
+        FILTER_NONE = 0,
+        /// \brief The speed-adaptive One Euro filter. Smooths jitter at rest
+        /// while keeping lag low when moving.
+        FILTER_ONE_EURO = 1,
+        /// \brief A constant-position Kalman filter for each axis.
+        FILTER_KALMAN = 2,
+        /// \brief An exponential moving average.
+        FILTER_EMA = 3
+    };
+
+    Filter filter = FILTER_NONE;
+
+    /// \brief The One Euro cutoff frequency at rest, in Hz.
+    float minCutoff = 1.0f;
+
+    /// \brief How quickly the One Euro cutoff rises with speed.
+    float beta = 0.007f;
+
+    /// \brief The One Euro cutoff frequency for the speed estimate, in Hz.
+    float derivativeCutoff = 1.0f;
+
+    /// \brief The Kalman process noise, in units² per second.
+    float processNoise = 50.0f;
+
+    /// \brief The Kalman measurement noise, in units².
+    float measurementNoise = 1.0f;
+
+    /// \brief The weight of the newest position in the EMA (0-1].
+    float smoothing = 0.5f;
+
+};
+
+
+/// \brief Smooths the positions of the touches on one device.
+///
+/// Each touch's filter state is taken from a fixed pool when the touch first
+/// appears, reset on MTTouchStateMakeTouch and returned to the pool on
+/// MTTouchStateOutOfRange or when the touch is missing from a frame.
+class TouchFilter
+{
+public:
+    TouchFilter();
+
+    /// \brief Filter the positions of every touch in a converted frame.
+    /// \param frame The frame to update.
+    /// \param timestamp The driver timestamp of the frame in seconds.
+    /// \param settings The filter options.
+    void apply(TouchFrame& frame, double timestamp, const FilterSettings& settings);
+
+    /// \brief Release all filter state.
+    void reset();
+
+private:
+    enum
+    {
+        POOL_SIZE = TouchFrame::CAPACITY
+    };
+
+    /// \brief The filter state of one axis.
+    struct AxisState
+    {
+        float value = 0;
+        float derivative = 0;
+        float variance = 0;
+
+        void reset(float position, const FilterSettings& settings);
+        float update(float position, float dt, const FilterSettings& settings);
+    };
+
+    struct FilterState
+    {
+        AxisState x;
+        AxisState y;
+        double timestamp = 0;
+    };
+
+    /// \brief A touch that holds a state from the pool.
+    struct ActiveTouch
+    {
+        int32_t pathIndex = -1;
+        uint8_t state = 0;
+        uint64_t frameCount = 0;
+    };
+
+    ActiveTouch* find(int32_t pathIndex, std::size_t hint);
+    void release(std::size_t activeIndex);
+
+    FilterState _pool[POOL_SIZE];
+
+    /// \brief A stack of unused pool indices.
+    uint8_t _free[POOL_SIZE];
+    std::size_t _numFree = POOL_SIZE;
+
+    ActiveTouch _active[POOL_SIZE];
+    std::size_t _numActive = 0;
+
+    uint64_t _frameCount = 0;
+
+    FilterSettings::Filter _filter = FilterSettings::FILTER_NONE;
+
+};
+
+
+} // ofx
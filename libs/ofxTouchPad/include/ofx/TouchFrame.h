@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include "ofx/TouchBuffer.h"
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+/// \brief The transform applied to every touch in a TouchFrame.
+///
+/// When normalizing, positions are mapped from [min, max] to [0, 1] and
+/// clamped, y is flipped, and the result is scaled and offset. Velocities are
+/// scaled (with y flipped) but not offset.
+class TouchFrameTransform
+{
+public:
+    /// \brief False to leave positions and velocities untouched.
+    bool normalize = true;
+
+    float minX = 0;
+    float minY = 0;
+    float maxX = 1;
+    float maxY = 1;
+
+    float scaleX = 1;
+    float scaleY = 1;
+    float offsetX = 0;
+    float offsetY = 0;
+
+};
+
+
+/// \brief A structure-of-arrays copy of a contact frame.
+///
+/// Each touch attribute is stored in its own aligned array so the whole frame
+/// can be converted at once by a vectorized kernel (SSE2 on x86, NEON on ARM
+/// and a scalar loop elsewhere). The arrays are padded to a multiple of the
+/// vector width, so the kernel needs no tail handling.
+class TouchFrame
+{
+public:
+    enum
+    {
+        /// \brief The maximum number of touches in one driver frame.
+        CAPACITY = 64
+    };
+
+    TouchFrame();
+
+    /// \brief Remove all touches.
+    void clear();
+
+    /// \brief Copy the contact frame from the driver into the arrays.
+    ///
+    /// Touches beyond CAPACITY are dropped.
+    ///
+    /// \param touches The driver touches.
+    /// \param numTouches The number of driver touches.
+    /// \param absolute True to copy the absolute (mm) vector rather than the
+    ///        normalized vector.
+    void assign(const MTTouch* touches, int32_t numTouches, bool absolute);
+
+    /// \brief Grow the given bounds to include every position in the frame.
+    void extendBounds(float& minX, float& minY, float& maxX, float& maxY) const;
+
+    /// \brief Apply the transform to the whole frame.
+    void transform(const TouchFrameTransform& transform);
+
+    /// \returns the number of touches.
+    std::size_t size() const;
+
+    /// \returns the name of the conversion kernel compiled in.
+    static const char* kernelName();
+
+    alignas(16) float x[CAPACITY];
+    alignas(16) float y[CAPACITY];
+    alignas(16) float vx[CAPACITY];
+    alignas(16) float vy[CAPACITY];
+    alignas(16) float ax[CAPACITY];
+    alignas(16) float ay[CAPACITY];
+    alignas(16) float predictedX[CAPACITY];
+    alignas(16) float predictedY[CAPACITY];
+    alignas(16) float majorAxis[CAPACITY];
+    alignas(16) float minorAxis[CAPACITY];
+    alignas(16) float angle[CAPACITY];
+    alignas(16) float pressure[CAPACITY];
+
+    int32_t pathIndex[CAPACITY];
+    MTTouchPhase phase[CAPACITY];
+
+private:
+    std::size_t _size = 0;
+
+};
+
+
+} // ofx
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include "ofx/TouchFrame.h"
+
+
+namespace ofx {
+
+
+/// \brief Options for estimating touch velocity and acceleration.
+class KinematicsSettings
+{
+public:
+    enum Estimator
+    {
+        /// \brief Use the velocity reported by the driver. Acceleration is 0.
+        ESTIMATOR_DRIVER = 0,
+        /// \brief Differences between the two latest samples.
+        ESTIMATOR_FINITE_DIFFERENCE = 1,
+        /// \brief A quadratic least-squares fit of the latest samples.
+        ESTIMATOR_LEAST_SQUARES = 2,
+        /// \brief An alpha-beta-gamma tracking filter.
+        ESTIMATOR_ALPHA_BETA = 3
+    };
+
+    Estimator estimator = ESTIMATOR_ALPHA_BETA;
+
+    /// \brief The number of samples fitted by ESTIMATOR_LEAST_SQUARES, from 3
+    /// to TouchKinematics::HISTORY_SIZE.
+    std::size_t window = 5;
+
+    /// \brief The position gain of ESTIMATOR_ALPHA_BETA (0-1].
+    float alpha = 0.5f;
+
+    /// \brief The velocity gain of ESTIMATOR_ALPHA_BETA.
+    float beta = 0.2f;
+
+    /// \brief The acceleration gain of ESTIMATOR_ALPHA_BETA.
+    float gamma = 0.02f;
+
+    /// \brief How far ahead to predict touch positions, in seconds.
+    ///
+    /// Rendering with predicted positions hides some of the input latency,
+    /// e.g. set this to the expected time until the next vsync. 0 disables
+    /// prediction.
+    float predictionHorizon = 0;
+
+};
+
+
+/// \brief Estimates the velocity and acceleration of the touches on one
+/// device.
+///
+/// Each touch keeps a short history of converted positions and driver
+/// timestamps. update() runs over a converted TouchFrame and replaces its
+/// velocities and fills its accelerations, in units of the current
+/// TouchPad::ScalingMode per second (and per second squared).
+///
+/// The driver reports every contact in every frame, so a touch that is
+/// missing from a frame is forgotten.
+class TouchKinematics
+{
+public:
+    enum
+    {
+        /// \brief The number of samples kept for each touch.
+        HISTORY_SIZE = 8
+    };
+
+    TouchKinematics();
+
+    /// \brief Estimate the velocity and acceleration of every touch.
+    /// \param frame The converted frame to update.
+    /// \param timestamp The driver timestamp of the frame in seconds.
+    /// \param settings The estimator options.
+    void update(TouchFrame& frame, double timestamp, const KinematicsSettings& settings);
+
+    /// \brief Extrapolate every touch forward in time.
+    ///
+    /// The predicted positions are p + v h + a h² / 2, using the velocities
+    /// and accelerations in the frame.
+    ///
+    /// \param frame The frame to update.
+    /// \param horizon The time h to predict ahead in seconds.
+    static void predict(TouchFrame& frame, float horizon);
+
+    /// \brief Forget all touches.
+    void reset();
+
+private:
+    struct TouchState
+    {
+        int32_t pathIndex = -1;
+        uint64_t frameCount = 0;
+
+        /// \brief A ring of the latest positions and timestamps.
+        float x[HISTORY_SIZE];
+        float y[HISTORY_SIZE];
+        double t[HISTORY_SIZE];
+        std::size_t head = 0;
+        std::size_t count = 0;
+
+        /// \brief The filtered position used by ESTIMATOR_ALPHA_BETA.
+        float fx = 0;
+        float fy = 0;
+
+        float vx = 0;
+        float vy = 0;
+        float ax = 0;
+        float ay = 0;
+
+        void start(float px, float py, double pt);
+        void push(float px, float py, double pt);
+    };
+
+    TouchState* find(int32_t pathIndex);
+
+    void estimateFiniteDifference(TouchState& state, float px, float py, float dt);
+    void estimateLeastSquares(TouchState& state, std::size_t window);
+    void estimateAlphaBeta(TouchState& state, float px, float py, float dt, const KinematicsSettings& settings);
+
+    TouchState _touches[TouchFrame::CAPACITY];
+    std::size_t _numTouches = 0;
+
+    uint64_t _frameCount = 0;
+
+};
+
+
+} // ofx
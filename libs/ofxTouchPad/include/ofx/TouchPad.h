@@ -4,77 +4,79 @@
 // SPDX-License-Identifier:	GPL
 //
 
-// Based on code from https://github.com/calftrail/TrackMagic (GPL v2.0)
-// Based on code from Jens Alexander Ewald http://www.520at.net
-// Based on code from Steike http://steike.com/code/multitouch
-
-////////////////////////////////////////////////////////////////////////////////
-// IMPORTANT!
-// You must include the MultitouchSupport.framework from:
-// /System/Library/PrivateFrameworks/MultitouchSupport.framework
-// in order to compile.
-////////////////////////////////////////////////////////////////////////////////
-
 
 #pragma once
 
 
-#ifndef __APPLE_CC__
-    #error -- Currently this code only works with MAC OS X >= 10.5
-#else
-    #if (MAC_OS_X_VERSION_MAX_ALLOWED < MAC_OS_X_VERSION_10_5)
-        #error -- This needs OS X 10.5 (Leopard) or higher!\n \
-            \t\tCheck your current SDK settings and add the \
-            \t\/tMultitouchSupport.framework from the PrivateFrameworks folder
-    #endif
-#endif
-
-
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <map>
+#include <memory>
+#include <mutex>
 #include "ofAppRunner.h"
 #include "ofEvents.h"
 #include "ofRectangle.h"
 #include "ofUtils.h"
-#include "MTTypes.h"
+#include "ofx/ActiveTouchTable.h"
+#include "ofx/ContactFrameQueue.h"
+#include "ofx/DeviceCalibration.h"
+#include "ofx/DeviceManager.h"
+#include "ofx/FrameSource.h"
+#include "ofx/GestureRecognizer.h"
+#include "ofx/InputThread.h"
+#include "ofx/SharedValue.h"
+#include "ofx/TouchFilter.h"
+#include "ofx/TapRecognizer.h"
+#include "ofx/TouchBuffer.h"
+#include "ofx/TouchFrame.h"
+#include "ofx/TouchKinematics.h"
+#include "ofx/TouchPadStats.h"
+#include "ofx/TouchPhaseTracker.h"
+#include "ofx/TouchRecorder.h"
+#include "ofx/TouchSnapshot.h"
 
 
 namespace ofx {
 
 
-class TapCount
+/// \brief Options for TouchPad::setup().
+class TouchPadSettings
 {
 public:
-    TapCount() : lastTap(0), tapCount(0)
+    enum Backend
     {
-    }
+        /// \brief MultitouchSupport on OSX, evdev on Linux and a
+        /// SyntheticFrameSource elsewhere.
+        BACKEND_DEFAULT = 0,
+        /// \brief The OSX MultitouchSupport framework.
+        BACKEND_MULTITOUCH_SUPPORT = 1,
+        /// \brief Linux evdev devices.
+        BACKEND_EVDEV = 2,
+        /// \brief A SyntheticFrameSource with one device.
+        BACKEND_SYNTHETIC = 3
+    };
 
-    ~TapCount()
-    {
-    }
+    /// \brief The source of contact frames.
+    Backend backend = BACKEND_DEFAULT;
 
-    uint64_t lastTap;
-    uint64_t tapCount;
-};
+    /// \brief The devices to connect, or empty to connect all of them.
+    std::vector<int> deviceIds = { 0 };
 
+    /// \brief True to connect the devices once they are found.
+    bool autoConnect = true;
+
+    /// \brief True to find and connect devices on a background thread, so
+    /// setup() returns without waiting for the driver.
+    bool async = true;
+
+    /// \brief True to keep watching for devices that are plugged in or
+    /// unplugged after startup.
+    bool watchDevices = false;
+
+    /// \brief The time between looks for devices in seconds.
+    double pollInterval = 1.0;
 
-class DeviceInfo
-{
-public:
-    DeviceInfo(MTDeviceRef _ref, int _id, const ofRectangle& _rect):
-        ref(_ref),
-        id(_id),
-        rect(_rect)
-    {
-    }
-    
-    ~DeviceInfo()
-    {
-    }
-    
-    MTDeviceRef ref;
-    int id;
-    ofRectangle rect;
 };
 
 
@@ -88,7 +90,8 @@ public:
     {
         /// \brief Scale the touchpad coordinates to the size of the window.
         SCALE_TO_WINDOW = 0,
-        /// \brief Scale the touchpad coordinates to the given scaling rectangle.
+        /// \brief Scale the touchpad coordinates to the given scaling rectangle,
+        /// or to the window while no rectangle has been set.
         SCALE_TO_RECT   = 1,
         /// \brief Use touchpad coordinates scaled from 0-1.
         NORMALIZED      = 2,
@@ -96,12 +99,91 @@ public:
         ABSOLUTE        = 3
     };
 
+    enum DispatchMode
+    {
+        /// \brief Fire touch events on the driver callback thread.
+        DISPATCH_IMMEDIATE = 0,
+        /// \brief Queue converted frames and fire touch events on the oF
+        /// update thread.
+        DISPATCH_QUEUED    = 1,
+        /// \brief Like DISPATCH_QUEUED, but all frames queued since the last
+        /// update are merged and fired as one. Each touch moves at most
+        /// once per update, and its skipped positions are kept in
+        /// ContactFrame::history.
+        DISPATCH_COALESCED = 2
+    };
+
+    /// \brief Create a TouchPad with no devices.
+    ///
+    /// Nothing is enumerated or connected until setup() or setFrameSource()
+    /// is called. Each TouchPad is an independent pipeline with its own
+    /// devices, events and settings, though only one may use the
+    /// MultitouchSupport backend at a time.
+    TouchPad();
+
+    /// \brief Create a TouchPad and set it up.
+    /// \param settings The startup options.
+    explicit TouchPad(const TouchPadSettings& settings);
+
+    virtual ~TouchPad();
+
+    /// \brief Choose the backend and start finding and connecting devices.
+    ///
+    /// By default devices are enumerated and connected on the device
+    /// watcher's thread, so this returns at once. The connected event fires
+    /// as each device starts delivering frames. Any earlier source is
+    /// disconnected first.
+    ///
+    /// \param settings The startup options.
+    /// \returns false if the backend isn't available on this platform.
+    bool setup(const TouchPadSettings& settings = TouchPadSettings());
+
     std::size_t numDevices() const;
     OF_DEPRECATED_MSG("Use numDevices().", std::size_t getNumDevices() const);
 
     bool connect(int deviceId = DEFAULT_DEVICE_ID);
     bool disconnect(int deviceId = DEFAULT_DEVICE_ID);
 
+    /// \brief Watch for devices that are plugged in or unplugged.
+    ///
+    /// The device list is refreshed on a background thread every
+    /// DeviceManagerSettings::pollInterval, and devices are connected there,
+    /// so neither ever blocks the update or draw. A device keeps its id, and
+    /// so its touch ids and calibration, when it is plugged back in.
+    ///
+    /// Touches on a device that is unplugged are cancelled.
+    ///
+    /// \param settings The watcher options.
+    /// \returns false if the watcher is already running.
+    bool startDeviceWatcher(const DeviceManagerSettings& settings = DeviceManagerSettings());
+
+    /// \brief Stop watching for devices.
+    void stopDeviceWatcher();
+
+    /// \returns true if the watcher is running.
+    bool isDeviceWatcherRunning() const;
+
+    /// \brief Connect a device on the watcher's thread.
+    ///
+    /// The watcher is started without polling if it isn't running. The
+    /// connected event fires once the device is connected.
+    ///
+    /// \param deviceId The device id.
+    void connectAsync(int deviceId = DEFAULT_DEVICE_ID);
+
+    /// \brief Disconnect a device on the watcher's thread.
+    /// \param deviceId The device id.
+    void disconnectAsync(int deviceId = DEFAULT_DEVICE_ID);
+
+    /// \brief Get the device events.
+    ///
+    /// The events fire on the update thread, before the app's update().
+    /// Devices are only added and removed while the watcher is running, but
+    /// connected and disconnected fire for every connection.
+    ///
+    /// \returns the device events.
+    DeviceEvents& deviceEvents();
+
     std::size_t touchCount() const;
     OF_DEPRECATED_MSG("Use touchCount().", std::size_t getTouchCount() const);
 
@@ -112,9 +194,60 @@ public:
     OF_DEPRECATED_MSG("Use touchMap().", TouchMap getTouchMap() const);
 
     bool hasTouchId(int touchId) const;
+
+    /// \brief Make the id used for a touch in events and snapshots.
+    ///
+    /// Touch ids combine the device id and the driver's path index, so
+    /// touches from several devices never collide. Touches from device 0
+    /// keep their path index as their id.
+    ///
+    /// \param deviceId The device id.
+    /// \param pathIndex The driver path index.
+    /// \returns the touch id.
+    static int touchId(int deviceId, int pathIndex);
+
+    /// \returns the id of the device that produced the touch.
+    static int touchDeviceId(int touchId);
+
+    /// \returns the driver path index of the touch.
+    static int touchPathIndex(int touchId);
+
+    /// \brief Get the active touches as of the latest contact frame.
+    ///
+    /// A new snapshot is published once per contact frame. Reading it never
+    /// locks, allocates or waits for the driver thread. The returned view is
+    /// valid and unchanged until the next call to snapshot().
+    ///
+    /// snapshot() has a single reader, normally the main thread. The legacy
+    /// touchCount(), touches(), touchMap() and hasTouchId() calls read a
+    /// copy of each snapshot under their own lock, so they are safe on any
+    /// thread.
+    ///
+    /// \returns the latest snapshot.
+    const TouchSnapshot& snapshot() const;
     
+    /// \returns the longest time in milliseconds between two taps of a
+    /// double tap.
     uint64_t getDoubleTapSpeed() const;
+
+    /// \brief Set the longest time between two taps of a double tap.
+    ///
+    /// This is the TapSettings::multiTapInterval in milliseconds.
+    ///
+    /// \param doubleTapSpeed The time in milliseconds.
     void setDoubleTapSpeed(uint64_t doubleTapSpeed);
+
+    /// \brief Get the tap events.
+    ///
+    /// Taps, multi-finger taps and long presses are recognized separately for
+    /// each device. Single finger double taps also fire the core
+    /// touchDoubleTap event.
+    ///
+    /// \returns the tap events.
+    TapEvents& tapEvents();
+
+    TapSettings getTapSettings() const;
+    void setTapSettings(const TapSettings& settings);
     
     ScalingMode getScalingMode() const;
     void setScalingMode(ScalingMode scalingMode);
@@ -122,76 +255,480 @@ public:
     const ofRectangle& getScalingRect() const;
     void setScalingRect(const ofRectangle& scalingRect);
 
+    FilterSettings getFilterSettings() const;
+
+    /// \brief Set how touch positions are smoothed.
+    ///
+    /// The settings are applied from the next frame. Setting them never
+    /// blocks the driver threads, so they can be tuned while running.
+    ///
+    /// \param settings The filter options.
+    void setFilterSettings(const FilterSettings& settings);
+
+    KinematicsSettings getKinematicsSettings() const;
+
+    /// \brief Set how touch velocity and acceleration are estimated.
+    ///
+    /// The estimates fill the xspeed, yspeed, xaccel and yaccel of every
+    /// touch event.
+    ///
+    /// \param settings The estimator options.
+    void setKinematicsSettings(const KinematicsSettings& settings);
+
+    DispatchMode getDispatchMode() const;
+
+    /// \brief Set the thread on which touch events are fired.
+    ///
+    /// In DISPATCH_QUEUED mode the driver callback only converts frames and
+    /// pushes them into a lock-free queue. The queue is drained and the
+    /// events are fired before the app's update().
+    ///
+    /// In DISPATCH_COALESCED mode the queued frames are merged first, so the
+    /// work done by listeners each update depends on the number of touches,
+    /// not the input rate. Down and up events are never merged away.
+    ///
+    /// \param dispatchMode The dispatch mode.
+    void setDispatchMode(DispatchMode dispatchMode);
+
+    /// \brief Run the frame pipeline on a dedicated input thread.
+    ///
+    /// By default frames are converted on whatever thread the driver calls
+    /// back on, and in DISPATCH_IMMEDIATE mode the listeners run there too.
+    /// With the input thread, the driver callback only copies the raw frame
+    /// into a lock-free ring and returns, and the thread converts it and, in
+    /// DISPATCH_IMMEDIATE mode, fires the events. Use DISPATCH_QUEUED or
+    /// DISPATCH_COALESCED to keep firing events on the update thread.
+    ///
+    /// The thread's priority and CPU can be set so that conversion keeps a
+    /// steady latency while the app is busy. Frames that arrive while the
+    /// ring is full are dropped and counted in statsJson().
+    ///
+    /// \param settings The thread options.
+    /// \returns false if the thread is already running.
+    bool startInputThread(const InputThreadSettings& settings = InputThreadSettings());
+
+    /// \brief Process the frames waiting for the input thread and stop it.
+    ///
+    /// Frames are converted on the driver thread again afterwards.
+    void stopInputThread();
+
+    /// \returns true if the input thread is running.
+    bool isInputThreadRunning() const;
+
+    /// \brief Get the frame event.
+    ///
+    /// The frame event fires once for each dispatched contact frame, before
+    /// the per-touch events, with every touch and hover in the frame. The
+    /// type of each touch is its phase: down, move, up or cancel. Apps that
+    /// handle many touches can listen to it and disable the core touch
+    /// events with disableCoreTouchEvents().
+    ///
+    /// \returns the frame event.
+    ofEvent<const ContactFrame>& frameEvent();
+
+    /// \brief Get the raw frame event.
+    ///
+    /// The raw frame event fires for every frame from the frame source,
+    /// before it is converted, with a view of the driver's MTTouch array.
+    /// This gives access to everything the driver reports, such as
+    /// zDensity, absolute positions in millimeters, finger and hand ids and
+    /// frame numbers, without copying the touches.
+    ///
+    /// Listeners run on the driver thread, or on the input thread if it is
+    /// running, and must not keep the view beyond the call.
+    ///
+    /// \returns the raw frame event.
+    ofEvent<const RawFrame>& rawFrameEvent();
+
+    /// \brief Stop converting frames into touch events.
+    ///
+    /// Only the raw frame event fires afterwards. Touches that are down are
+    /// cancelled with the device's next frame.
+    void disableFrameConversion();
+
+    /// \brief Convert frames into touch events again.
+    void enableFrameConversion();
+
+    /// \returns true if frames are converted into touch events.
+    bool isFrameConversionEnabled() const;
+
+    /// \brief Stop firing the core touch events.
+    ///
+    /// touchDown, touchMoved, touchUp, touchCancelled and touchDoubleTap are
+    /// no longer fired for the trackpad; frameEvent() and the gesture and
+    /// tap events still are. A running app always has listeners on the core
+    /// events, its own ofBaseApp handlers, so apps that only use
+    /// frameEvent() should call this to avoid preparing and notifying an
+    /// event for every touch of every frame.
+    void disableCoreTouchEvents();
+
+    /// \brief Fire the core touch events again. They are enabled by default.
+    void enableCoreTouchEvents();
+
+    /// \returns true if the core touch events are fired.
+    bool areCoreTouchEventsEnabled() const;
+
+    /// \brief Get the earlier positions of the touches being fired.
+    ///
+    /// When frames are coalesced, a touch's move event skips the positions
+    /// it passed through since its previous event. Call this from a touch
+    /// listener to get them, oldest first.
+    ///
+    /// \returns the history of the frame being fired, or an empty history
+    /// outside of touch listeners.
+    const TouchHistory& history() const;
+
+    ContactFrameQueue::OverflowPolicy getQueueOverflowPolicy() const;
+    void setQueueOverflowPolicy(ContactFrameQueue::OverflowPolicy policy);
+
+    /// \returns the number of frames waiting to be dispatched.
+    std::size_t queueDepth() const;
+
+    /// \returns the number of frames that arrived while the queue was full.
+    uint64_t queueOverflowCount() const;
+
+    /// \returns the number of frames lost to queue overflow.
+    uint64_t queueDroppedFrameCount() const;
+
+    /// \brief Get the gesture events.
+    ///
+    /// Pan, pinch, rotate and swipe gestures are recognized separately for
+    /// each device, on the same thread as the touch events.
+    ///
+    /// \returns the gesture events.
+    GestureEvents& gestureEvents();
+
+    GestureSettings getGestureSettings() const;
+    void setGestureSettings(const GestureSettings& settings);
+
+    /// \brief Get the hover event.
+    ///
+    /// Fingers that are in range of the pad but not touching it hover. The
+    /// event type is down when a finger comes into range, move while it
+    /// hovers and up when it touches or leaves range.
+    ///
+    /// \returns the hover event.
+    ofEvent<ofTouchEventArgs>& hoverEvent();
+
     void disableCoreMouseEvents();
     void enableCoreMouseEvents();
 
     void disableOSGestureSupport();
     void enableOSGestureSupport();
 
-    /// \returns a singleton TouchPad instance.
+    /// \brief Replace the source of contact frames.
+    ///
+    /// Any devices connected through the current source are disconnected. The
+    /// new source's device list is refreshed, but no device is connected.
+    ///
+    /// \param source The new frame source.
+    void setFrameSource(std::unique_ptr<FrameSource> source);
+
+    /// \returns the current source of contact frames.
+    FrameSource& frameSource();
+
+    /// \returns the current source of contact frames.
+    const FrameSource& frameSource() const;
+
+    /// \brief Get the learned position range of a device.
+    /// \param deviceId The device id.
+    /// \returns the calibration, or nullptr if there is no such device.
+    const DeviceCalibration* calibration(int deviceId) const;
+
+    /// \brief Forget the learned position range of a device.
+    /// \param deviceId The device id.
+    void resetCalibration(int deviceId);
+
+    /// \brief Load learned position ranges saved with saveCalibration().
+    ///
+    /// This avoids a warm-up period at startup during which positions are
+    /// mapped with the default range. Calibrations are matched to devices by
+    /// their identity, and are kept for devices that haven't been found yet
+    /// so they apply as soon as the device appears.
+    ///
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the file was loaded.
+    bool loadCalibration(const std::string& path);
+
+    /// \brief Save the learned position range of every device.
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the file was saved.
+    bool saveCalibration(const std::string& path) const;
+
+    /// \brief Get the counters and timings of a device.
+    ///
+    /// The stats are updated without locking and can be read at any time.
+    /// The pointer stays valid until setup() or setFrameSource() replaces the
+    /// frame source, or the TouchPad is destroyed; don't keep it past that.
+    ///
+    /// \param deviceId The device id.
+    /// \returns the stats, or nullptr if there is no such device.
+    const DeviceStats* stats(int deviceId) const;
+
+    /// \brief Zero the stats of every device.
+    void resetStats();
+
+    /// \returns the stats of every device and the dispatch queue.
+    ofJson statsJson() const;
+
+    /// \brief Save statsJson() to a file.
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the file was saved.
+    bool saveStats(const std::string& path) const;
+
+    /// \brief Get the recorder for raw contact frames.
+    ///
+    /// While the recorder is started, every raw frame from the current
+    /// FrameSource is recorded before it is converted.
+    ///
+    /// \returns the recorder.
+    TouchRecorder& recorder();
+
+    /// \brief Get the shared TouchPad.
+    ///
+    /// It is created on first use and set up with the default
+    /// TouchPadSettings, which connect device 0 in the background.
+    ///
+    /// \returns the shared TouchPad.
     static TouchPad& instance();
 
     enum
     {
         DEFAULT_DEVICE_ID = 0,
-        DEFAULT_DOUBLE_TAP_SPEED = 500
+        DEFAULT_DOUBLE_TAP_SPEED = 500,
+        /// \brief The most devices, counting those that were unplugged.
+        MAX_DEVICES = 64
     };
 
-private:
-    typedef std::map<int, DeviceInfo*> DeviceMap;
-
     enum
     {
-        MAX_TOUCHES = 1024
-
+        TOUCH_ID_DEVICE_SHIFT = 16,
+        TOUCH_ID_PATH_MASK = 0xFFFF
     };
 
-    // singleton
-    TouchPad();
-    virtual ~TouchPad();
+private:
     TouchPad(const TouchPad&);
     TouchPad& operator=(const TouchPad&);
 
     void exit(ofEventArgs& etc);
+    void update(ofEventArgs& etc);
+
+    /// \brief Fire the core touchDoubleTap event for single finger double taps.
+    void onTap(TapEventArgs& tap);
+
+    void registerTouchEvents(const ContactFrame& frame);
+
+    /// \brief Convert and dispatch a single contact frame.
+    ///
+    /// This is called from the frame callback installed on the current
+    /// FrameSource, or from the input thread.
+    void processFrame(int deviceId,
+                      const MTTouch* touches,
+                      int32_t numTouches,
+                      double timestamp,
+                      int32_t frameNum,
+                      std::chrono::steady_clock::time_point receivedTime);
+
+    void disconnectAll();
+
+    /// \brief Disconnect the current source and install a new one without
+    /// enumerating its devices.
+    void installFrameSource(std::unique_ptr<FrameSource> source);
+
+    /// \brief Cancel the touches left on a device that stopped delivering
+    /// frames.
+    ///
+    /// Frames of the device are refused from then on, and the frame
+    /// callbacks and input thread are waited for first, so no stale frame of
+    /// the device is processed during or after the cancel. Must be called
+    /// without _sourceMutex.
+    void cancelTouches(int deviceId);
+
+    /// \brief Wait until no frame callback is running, other than those
+    /// further up the calling thread's stack.
+    void waitForFrameCallbacks() const;
+
+    /// \brief Allocate the state of every device in the frame source.
+    ///
+    /// Must be called with _sourceMutex held.
+    void allocateDeviceStates();
+
+    /// \returns the description of a device for the device events.
+    DeviceEventArgs deviceEventArgs(int deviceId) const;
+
+    /// \brief The settings read by the frame and dispatch threads.
+    struct PipelineSettings
+    {
+        ScalingMode scalingMode = SCALE_TO_WINDOW;
 
-    void registerTouchEvents(const Touches& touchEvents);
-    
-    static void mt_callback(MTDeviceRef deviceId,
-                            MTTouch* touches,
-                            int32_t numTouches,
-                            double timestamp,
-                            int32_t frameNum);
+        /// \brief The scaling rectangle's x, y, width and height.
+        float scalingRect[4] = { 0, 0, 0, 0 };
+
+        KinematicsSettings kinematics;
+        TapSettings taps;
+        GestureSettings gestures;
 
-    ScalingMode _scalingMode;
+        /// \brief True to fire the core per-touch events.
+        bool isCoreTouchEventsEnabled = true;
+    };
+
+    /// \brief Published so that the frame threads never wait for a lock
+    /// held by the app or by listeners. Writers hold _mutex.
+    SharedValue<PipelineSettings> _settings;
+
+    /// \brief The scaling rectangle returned by getScalingRect().
     ofRectangle _scalingRectangle;
 
-    // We keep track of normalized position because the driver isn't delivering
-    // values in the range 0-1 in all cases.
-    static float _minNormalizedPositionX;
-    static float _minNormalizedPositionY;
-    static float _maxNormalizedPositionX;
-    static float _maxNormalizedPositionY;
+    /// \brief The filter options, published like _settings.
+    SharedValue<FilterSettings> _filterSettings;
 
-    void refreshDeviceList();
-    CFMutableArrayRef _deviceList;
-    std::size_t _nDevices;
-    
-    TouchMap _activeTouches;
-    DeviceMap _devices;
+    std::unique_ptr<FrameSource> _frameSource;
+
+    /// \brief The state of a single device, used by its frame thread.
+    struct DeviceState
+    {
+        /// \brief The converted frame, reused for every contact frame.
+        ContactFrame frame;
+
+        /// \brief The structure-of-arrays frame for the conversion kernel.
+        TouchFrame touchFrame;
+
+        // We keep track of normalized position because the driver isn't
+        // delivering values in the range 0-1 in all cases.
+        DeviceCalibration calibration;
+
+        /// \brief The position filter.
+        TouchFilter filter;
+
+        /// \brief The velocity and acceleration estimator.
+        TouchKinematics kinematics;
+
+        /// \brief The lifecycle of each touch.
+        TouchPhaseTracker phases;
+
+        /// \brief The value of _dispatchCount when the device last had
+        /// events dispatched.
+        uint64_t dispatchCount = 0;
+
+        TapRecognizer taps;
+
+        GestureRecognizer gestures;
+
+        DeviceStats stats;
+
+        /// \brief False once the device's touches were cancelled, until it is
+        /// connected again. Late frame callbacks of the device are dropped.
+        std::atomic<bool> acceptsFrames{true};
+    };
+
+    /// \returns the state of a device, or nullptr if there is none.
+    DeviceState* deviceState(int deviceId) const;
+
+    /// \brief Apply the loaded calibration of a device, if there is one.
+    void applyLoadedCalibration(int deviceId);
+
+    /// \brief Per-device state, allocated as devices are found.
+    ///
+    /// The table never moves, so frame threads can read it while devices are
+    /// added. The first _numDeviceStates entries are allocated.
+    std::array<std::unique_ptr<DeviceState>, MAX_DEVICES> _deviceStates;
+    std::atomic<std::size_t> _numDeviceStates{0};
+
+    /// \brief The calibrations from loadCalibration() by device identity.
+    ///
+    /// Guarded by _sourceMutex.
+    std::map<std::string, ofJson> _loadedCalibrations;
+
+    /// \brief Serializes the frame source's refresh, connect and disconnect
+    /// across the app and watcher threads.
+    mutable std::recursive_mutex _sourceMutex;
+
+    /// \brief The number of frame callbacks that are running.
+    ///
+    /// Device states aren't reset or freed until it drops to zero, as a frame
+    /// thread may still be using them after a device was disconnected.
+    std::atomic<int> _activeCallbacks{0};
+
+    DeviceManager _deviceManager;
+    DeviceEvents _deviceEvents;
+
+    std::atomic<int> _dispatchMode{DISPATCH_IMMEDIATE};
+
+    /// \brief The value of FrameSource::hasSteadyTimestamps().
+    std::atomic<bool> _hasSteadyTimestamps{false};
+
+    TouchRecorder _recorder;
+
+    /// \brief Runs processFrame() when enabled with startInputThread().
+    InputThread _inputThread;
+
+    /// \brief Converted frames waiting for the update thread.
+    ContactFrameQueue _frameQueue;
+
+    /// \brief The frame being dispatched from the queue.
+    ContactFrame _dispatchFrame;
+
+    /// \brief A queued frame being merged into _dispatchFrame.
+    ContactFrame _coalesceFrame;
+
+    /// \brief The dispatched frame with cancels for lost touches added.
+    ContactFrame _eventFrame;
+
+    ofEvent<const ContactFrame> _frameEvent;
+
+    ofEvent<const RawFrame> _rawFrameEvent;
+
+    std::atomic<bool> _isFrameConversionEnabled{true};
+
+    /// \brief The history of the frame being fired, if any.
+    const TouchHistory* _dispatchHistory = nullptr;
+
+    TouchHistory _emptyHistory;
+
+    /// \brief Counts calls to registerTouchEvents().
+    uint64_t _dispatchCount = 0;
+
+    /// \brief The touches that are down on every device.
+    ActiveTouchTable _activeTouches;
+
+    /// \brief The value of _dispatchCount when each slot was last updated.
+    uint64_t _activeTouchDispatchCounts[ActiveTouchTable::CAPACITY] = {};
+
+    /// \brief Snapshots of _activeTouches for lock-free readers.
+    TripleBuffer<TouchSnapshot> _snapshots;
+    uint64_t _snapshotVersion = 0;
+
+    /// \brief Copies of the snapshots for the legacy accessors.
+    TripleBuffer<TouchSnapshot> _legacySnapshots;
+
+    /// \brief Serializes the readers of _legacySnapshots. The writer never
+    /// takes it.
+    mutable std::mutex _legacySnapshotMutex;
     
-    uint64_t _doubleTapSpeed; // ms
-    TapCount _tapCounts[MAX_TOUCHES];   // an internal tap counter
+    TapEvents _tapEvents;
+
+    GestureEvents _gestureEvents;
+
+    ofEvent<ofTouchEventArgs> _hoverEvent;
 
     static std::string touchPhaseToString(MTTouchPhase phase);
-    static void printDeviceInfo(MTDeviceRef d);
     
-    mutable std::mutex _mutex; // to synchronize the system and oF event threads
+    /// \brief Serializes the settings writers.
+    mutable std::mutex _mutex;
+
+    /// \brief Serializes registerTouchEvents() and guards the active touch
+    /// table. No frame thread takes it in the queued dispatch modes.
+    std::mutex _dispatchMutex;
 
     bool _disableOSGestureSupport = false;
 
     // To ensure that no global oF methods are called before exit.
     ofEventListener _exitListener;
 
+    ofEventListener _updateListener;
+
+    ofEventListener _tapListener;
+
 };
     
 
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "ofJson.h"
+
+
+namespace ofx {
+
+
+/// \brief A lock-free histogram of durations in nanoseconds.
+///
+/// Like an HDR histogram, buckets are linear within each power of two, so
+/// every recorded value keeps about two significant digits (within 1/16 of
+/// its value) from 1 ns up to about 18 minutes. Values beyond the range are
+/// counted in the last bucket.
+///
+/// record() may be called from any number of threads at once and never
+/// locks or allocates. Reads are safe at any time, but a read made during a
+/// record() may see the new count before the new maximum.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    /// \brief Add a duration.
+    /// \param nanoseconds The duration in nanoseconds.
+    void record(uint64_t nanoseconds);
+
+    /// \returns the number of recorded durations.
+    uint64_t count() const;
+
+    /// \returns the shortest recorded duration in nanoseconds.
+    uint64_t min() const;
+
+    /// \returns the longest recorded duration in nanoseconds.
+    uint64_t max() const;
+
+    /// \returns the mean duration in nanoseconds.
+    double mean() const;
+
+    /// \brief Get a percentile of the recorded durations.
+    /// \param percentile The percentile (0-100).
+    /// \returns the highest duration in the bucket holding the percentile, in
+    /// nanoseconds.
+    uint64_t percentile(double percentile) const;
+
+    /// \brief Forget all durations.
+    ///
+    /// Durations recorded during the reset may be partly kept.
+    void reset();
+
+    /// \returns the count, min, mean, max and common percentiles.
+    ofJson toJson() const;
+
+private:
+    LatencyHistogram(const LatencyHistogram&);
+    LatencyHistogram& operator=(const LatencyHistogram&);
+
+    enum
+    {
+        /// \brief Each power of two is split into 2^SUB_BUCKET_BITS buckets.
+        SUB_BUCKET_BITS = 4,
+        SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS,
+        /// \brief The highest power of two that is tracked.
+        MAX_EXPONENT = 40,
+        BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKET_COUNT
+    };
+
+    static std::size_t bucket(uint64_t value);
+
+    /// \returns the highest value that falls in a bucket.
+    static uint64_t bucketMax(std::size_t bucket);
+
+    std::atomic<uint64_t> _buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> _count;
+    std::atomic<uint64_t> _sum;
+    std::atomic<uint64_t> _min;
+    std::atomic<uint64_t> _max;
+
+};
+
+
+/// \brief Counters and timings for one device.
+///
+/// The counters and histograms are updated on the frame and dispatch threads
+/// without locking and may be read from any thread.
+class DeviceStats
+{
+public:
+    DeviceStats();
+
+    /// \brief Contact frames received from the frame source.
+    std::atomic<uint64_t> framesReceived;
+
+    /// \brief Driver touches converted.
+    std::atomic<uint64_t> touchesConverted;
+
+    /// \brief Driver touches dropped because a frame held more than
+    /// TouchFrame::CAPACITY.
+    std::atomic<uint64_t> touchesDropped;
+
+    /// \brief Touch and hover events dispatched.
+    std::atomic<uint64_t> eventsDispatched;
+
+    /// \brief Down and move events whose touch was left out of the active
+    /// touch table because it held ActiveTouchTable::CAPACITY touches. These
+    /// touches are still dispatched but are missing from snapshots.
+    std::atomic<uint64_t> untrackedEvents;
+
+    /// \brief Cancel events for lost touches that did not fit in the
+    /// dispatched frame.
+    std::atomic<uint64_t> cancelsDropped;
+
+    /// \brief The time to convert a frame, including queueing or dispatching
+    /// it. This runs in the frame callback, or on the input thread if it is
+    /// running.
+    LatencyHistogram callbackTime;
+
+    /// \brief The time to dispatch a converted frame.
+    LatencyHistogram dispatchTime;
+
+    /// \brief The part of dispatchTime spent in frame, touch and hover
+    /// listeners.
+    LatencyHistogram listenerTime;
+
+    /// \brief The time from receiving a frame to dispatching it. This is
+    /// mostly time spent in the queue in DISPATCH_QUEUED mode.
+    LatencyHistogram deliveryLatency;
+
+    /// \brief The time from the frame callback to the input thread picking
+    /// up a frame. Only recorded while the input thread runs.
+    LatencyHistogram inputLatency;
+
+    /// \brief The time from the driver timestamp to dispatching a frame.
+    ///
+    /// Only recorded if FrameSource::hasSteadyTimestamps() is true.
+    LatencyHistogram driverLatency;
+
+    /// \brief Zero every counter and histogram.
+    void reset();
+
+    ofJson toJson() const;
+
+private:
+    DeviceStats(const DeviceStats&);
+    DeviceStats& operator=(const DeviceStats&);
+
+};
+
+
+} // ofx
@@ -0,0 +1,118 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <cstdint>
+#include "ofx/TouchBuffer.h"
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+/// \brief Turns the driver's touch phases into touch and hover events for
+/// one device.
+///
+/// Every touch follows an explicit lifecycle:
+///
+///     (none) -> hovering <-> touching -> (none)
+///
+/// Each driver phase moves a touch through the lifecycle and appends the
+/// resulting events to a ContactFrame:
+///
+/// - StartInRange, HoverInRange and LingerInRange hover. A touching finger
+///   lifts (up) first.
+/// - MakeTouch and Touching touch. A finger that wasn't touching goes down
+///   first, even if its MakeTouch was missed.
+/// - BreakTouch lifts a touching finger (up), which then hovers.
+/// - OutOfRange ends the touch (up) or the hover.
+/// - NotTracking cancels a touching finger.
+///
+/// Hover events are appended to ContactFrame::hovers, with type down on
+/// entering range, move while hovering and up on leaving range.
+///
+/// The driver reports every contact in every frame, so a touch that is
+/// missing from a frame was lost: a touching finger is cancelled and a
+/// hovering finger leaves range. No touch can be left behind.
+class TouchPhaseTracker
+{
+public:
+    enum State
+    {
+        STATE_NONE = 0,
+        STATE_HOVERING = 1,
+        STATE_TOUCHING = 2
+    };
+
+    TouchPhaseTracker();
+
+    /// \brief Start a new frame.
+    void beginFrame();
+
+    /// \brief Advance one touch of the frame.
+    /// \param touch The converted touch; its type is ignored.
+    /// \param predicted The predicted position of the touch.
+    /// \param phase The driver phase of the touch.
+    /// \param frame The frame to append events to.
+    void update(const ofTouchEventArgs& touch,
+                const glm::vec2& predicted,
+                MTTouchPhase phase,
+                ContactFrame& frame);
+
+    /// \brief Finish the frame, ending touches that were missing from it.
+    /// \param frame The frame to append events to.
+    void endFrame(ContactFrame& frame);
+
+    /// \brief End every touch, e.g. when the device is disconnected.
+    ///
+    /// Touching fingers are cancelled and hovering fingers leave range.
+    ///
+    /// \param frame The frame to append events to.
+    void cancelAll(ContactFrame& frame);
+
+    /// \returns the state of a touch.
+    State state(int touchId) const;
+
+    /// \returns the number of touches being tracked.
+    std::size_t size() const;
+
+private:
+    struct Entry
+    {
+        State state = STATE_NONE;
+        uint64_t frameCount = 0;
+
+        /// \brief The latest converted touch, used to end a lost touch.
+        ofTouchEventArgs touch;
+        glm::vec2 predicted;
+    };
+
+    Entry* find(int touchId, std::size_t hint);
+
+    /// \brief End a touch that is no longer reported.
+    void end(const Entry& entry, ofTouchEventArgs::Type touchType, ContactFrame& frame);
+
+    static void append(TouchBuffer& buffer,
+                       const ofTouchEventArgs& touch,
+                       ofTouchEventArgs::Type type,
+                       const glm::vec2& predicted);
+
+    Entry _entries[TouchBuffer::CAPACITY];
+    std::size_t _size = 0;
+
+    uint64_t _frameCount = 0;
+
+    /// \brief The number of updates in the current frame.
+    std::size_t _updateCount = 0;
+
+};
+
+
+} // ofx
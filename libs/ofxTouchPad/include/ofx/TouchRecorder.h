@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ofx/TouchRecording.h"
+
+
+namespace ofx {
+
+
+/// \brief Records raw contact frames to an append-only binary file.
+///
+/// record() only copies the frame into a lock-free byte ring, which a
+/// background thread flushes to disk, so recording never blocks the driver
+/// callback thread. If the writer falls behind and the ring is full, frames
+/// are dropped and counted rather than delaying live input.
+///
+/// Several driver threads may record. They are serialized with a spin lock
+/// that only covers the copy, and the writer never takes it. start() and
+/// stop() take the same lock to switch recording on and off, so a frame is
+/// never copied into a ring that is being reset.
+///
+/// The file layout is described by TouchRecording.
+class TouchRecorder
+{
+public:
+    /// \brief Create a TouchRecorder.
+    /// \param bufferSize The size of the in-memory ring in bytes.
+    TouchRecorder(std::size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    ~TouchRecorder();
+
+    /// \brief Start recording to a file, replacing any existing file.
+    /// \param path The path, relative to the data folder.
+    /// \returns true if the file was opened.
+    bool start(const std::string& path);
+
+    /// \brief Flush all buffered frames and close the file.
+    void stop();
+
+    /// \returns true if recording.
+    bool isRecording() const;
+
+    /// \brief Append a raw frame. Safe on any thread.
+    /// \returns false if the frame was dropped.
+    bool record(int deviceId,
+                const MTTouch* touches,
+                int32_t numTouches,
+                double timestamp,
+                int32_t frameNum);
+
+    /// \returns the number of frames handed to the writer.
+    uint64_t recordedFrameCount() const;
+
+    /// \returns the number of frames dropped because the ring was full.
+    uint64_t droppedFrameCount() const;
+
+    /// \returns true if writing to the file failed since start(). The
+    /// frames that couldn't be written are lost.
+    bool hasWriteError() const;
+
+    enum
+    {
+        DEFAULT_BUFFER_SIZE = 1 << 20
+    };
+
+private:
+    TouchRecorder(const TouchRecorder&);
+    TouchRecorder& operator=(const TouchRecorder&);
+
+    void write(const void* data, std::size_t size, std::size_t position);
+    void writerThread();
+
+    /// \brief Write everything between the read and write positions.
+    void flush();
+
+    /// \brief Log a failed file write, once per recording.
+    void reportWriteError(const char* operation);
+
+    void lockPush();
+    void unlockPush();
+
+    std::vector<uint8_t> _buffer;
+
+    alignas(64) std::atomic<std::size_t> _writePosition;
+
+    /// \brief Held by the thread that is recording a frame.
+    std::atomic<bool> _isPushing;
+
+    alignas(64) std::atomic<std::size_t> _readPosition;
+
+    std::FILE* _file = nullptr;
+    std::thread _thread;
+
+    std::atomic<bool> _isRecording;
+    std::atomic<uint64_t> _recordedFrameCount;
+    std::atomic<uint64_t> _droppedFrameCount;
+    std::atomic<bool> _hasWriteError;
+
+};
+
+
+} // ofx
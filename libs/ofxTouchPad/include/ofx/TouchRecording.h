@@ -0,0 +1,93 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <vector>
+#include "MTTypes.h"
+
+
+namespace ofx {
+
+
+/// \brief The binary layout of a raw contact frame recording.
+///
+/// A recording is a FileHeader, followed by FileHeader::numFields FieldInfo
+/// entries describing the recorded MTTouch struct, followed by frames until
+/// the end of the file. Each frame is a FrameHeader followed by
+/// FrameHeader::numTouches MTTouch structs, copied byte for byte from the
+/// driver. All values are in host byte order; FileHeader::byteOrderMark
+/// identifies it.
+class TouchRecording
+{
+public:
+    enum
+    {
+        VERSION = 1,
+        BYTE_ORDER_MARK = 0x01020304,
+        FIELD_NAME_LENGTH = 20
+    };
+
+    enum FieldType
+    {
+        FIELD_INT32 = 0,
+        FIELD_FLOAT32 = 1,
+        FIELD_FLOAT64 = 2
+    };
+
+    struct FileHeader
+    {
+        /// \brief "OFXTPREC", not null terminated.
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        /// \brief The size of the FileHeader and the field table in bytes.
+        uint32_t headerSize;
+        /// \brief sizeof(MTTouch) on the recording machine.
+        uint32_t touchSize;
+        uint32_t numFields;
+        uint32_t reserved;
+    };
+
+    struct FieldInfo
+    {
+        /// \brief The MTTouch member name, null terminated.
+        char name[FIELD_NAME_LENGTH];
+        uint32_t offset;
+        uint32_t size;
+        uint32_t type;
+    };
+
+    struct FrameHeader
+    {
+        int32_t deviceId;
+        int32_t numTouches;
+        /// \brief The MTContactCallbackFunction timestamp in seconds.
+        double timestamp;
+        /// \brief The MTContactCallbackFunction frame number.
+        int32_t frameNum;
+        int32_t reserved;
+    };
+
+    /// \returns the magic bytes that start every recording.
+    static const char* magic();
+
+    /// \returns the field table describing the MTTouch layout of this build.
+    static std::vector<FieldInfo> touchFields();
+
+    /// \returns a file header for this build.
+    static FileHeader makeFileHeader();
+
+    /// \returns the size in bytes of a frame with the given number of touches.
+    static std::size_t frameSize(int32_t numTouches);
+
+};
+
+
+} // ofx
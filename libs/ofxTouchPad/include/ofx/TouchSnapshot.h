@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "ofx/TouchBuffer.h"
+
+
+namespace ofx {
+
+
+/// \brief The active touches as of a single contact frame.
+class TouchSnapshot
+{
+public:
+    /// \brief Increases by one for each published snapshot.
+    uint64_t version = 0;
+
+    /// \brief The driver timestamp of the latest frame in seconds.
+    double timestamp = 0;
+
+    /// \brief The active touches, in slot order.
+    TouchBuffer touches;
+
+    /// \brief The ActiveTouchTable slot of each touch.
+    std::array<uint8_t, TouchBuffer::CAPACITY> slots;
+
+    std::size_t size() const
+    {
+        return touches.size();
+    }
+
+    bool empty() const
+    {
+        return touches.empty();
+    }
+
+    const ofTouchEventArgs& operator [] (std::size_t i) const
+    {
+        return touches[i];
+    }
+
+    /// \returns the predicted position of a touch.
+    const glm::vec2& predicted(std::size_t i) const
+    {
+        return touches.predicted(i);
+    }
+
+    /// \brief Get the slot of a touch.
+    ///
+    /// A touch keeps its slot from down to up, so the slot can be used to
+    /// track it across snapshots, e.g. as an index into per-touch app state.
+    /// A slot is reused by a later touch once its touch is up.
+    ///
+    /// \returns the slot of a touch, less than ActiveTouchTable::CAPACITY.
+    std::size_t slot(std::size_t i) const
+    {
+        return slots[i];
+    }
+
+    const ofTouchEventArgs* begin() const
+    {
+        return touches.begin();
+    }
+
+    const ofTouchEventArgs* end() const
+    {
+        return touches.end();
+    }
+
+};
+
+
+/// \brief A wait-free triple buffer for one writer and one reader.
+///
+/// The writer fills back() and calls publish(). The reader calls front(),
+/// which returns the most recently published value. The returned reference
+/// stays valid and unchanged until the reader calls front() again. Neither
+/// side ever waits for the other.
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+    {
+    }
+
+    /// \returns the buffer to fill. Writer only.
+    T& back()
+    {
+        return _buffers[_back];
+    }
+
+    /// \brief Make the back buffer visible to the reader. Writer only.
+    void publish()
+    {
+        uint8_t previous = _middle.exchange(_back | DIRTY, std::memory_order_acq_rel);
+        _back = previous & INDEX_MASK;
+    }
+
+    /// \returns the most recently published buffer. Reader only.
+    const T& front() const
+    {
+        if (_middle.load(std::memory_order_relaxed) & DIRTY)
+        {
+            uint8_t previous = _middle.exchange(_front, std::memory_order_acq_rel);
+            _front = previous & INDEX_MASK;
+        }
+
+        return _buffers[_front];
+    }
+
+private:
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+
+    enum
+    {
+        INDEX_MASK = 0x3,
+        DIRTY = 0x4
+    };
+
+    T _buffers[3];
+
+    uint8_t _back = 0;
+    mutable std::atomic<uint8_t> _middle{1};
+    mutable uint8_t _front = 2;
+
+};
+
+
+} // ofx
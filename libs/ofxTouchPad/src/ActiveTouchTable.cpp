@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/ActiveTouchTable.h"
+
+
+namespace ofx {
+
+
+static_assert(ActiveTouchTable::CAPACITY < 0xFF, "Slots are stored as uint8_t.");
+
+
+ActiveTouchTable::ActiveTouchTable()
+{
+    clear();
+}
+
+
+std::size_t ActiveTouchTable::insert(const ofTouchEventArgs& touch, const glm::vec2& predicted)
+{
+    std::size_t entry = probe(touch.id);
+    std::size_t slot = _index[entry];
+
+    if (slot == EMPTY)
+    {
+        if (_numFree == 0)
+        {
+            return NO_SLOT;
+        }
+
+        slot = _free[--_numFree];
+        _index[entry] = static_cast<uint8_t>(slot);
+        _occupied[slot] = true;
+    }
+
+    _touches[slot] = touch;
+    _predicted[slot] = predicted;
+    return slot;
+}
+
+
+bool ActiveTouchTable::erase(int touchId)
+{
+    std::size_t entry = probe(touchId);
+    std::size_t slot = _index[entry];
+
+    if (slot == EMPTY)
+    {
+        return false;
+    }
+
+    _occupied[slot] = false;
+    _free[_numFree++] = static_cast<uint8_t>(slot);
+
+    // Shift later entries of the probe sequence back into the gap, so that
+    // lookups never need tombstones. Only the index moves; slots stay put.
+    std::size_t gap = entry;
+
+    for (std::size_t i = (gap + 1) & INDEX_MASK; _index[i] != EMPTY; i = (i + 1) & INDEX_MASK)
+    {
+        std::size_t home = hash(_touches[_index[i]].id);
+
+        // Move the entry unless its home lies cyclically within (gap, i].
+        if (((i - home) & INDEX_MASK) >= ((i - gap) & INDEX_MASK))
+        {
+            _index[gap] = _index[i];
+            gap = i;
+        }
+    }
+
+    _index[gap] = EMPTY;
+    return true;
+}
+
+
+void ActiveTouchTable::clear()
+{
+    for (std::size_t i = 0; i < INDEX_SIZE; ++i)
+    {
+        _index[i] = EMPTY;
+    }
+
+    for (std::size_t i = 0; i < CAPACITY; ++i)
+    {
+        _occupied[i] = false;
+        _free[i] = static_cast<uint8_t>(CAPACITY - 1 - i);
+    }
+
+    _numFree = CAPACITY;
+}
+
+
+std::size_t ActiveTouchTable::find(int touchId) const
+{
+    std::size_t slot = _index[probe(touchId)];
+
+    if (slot == EMPTY)
+    {
+        return NO_SLOT;
+    }
+
+    return slot;
+}
+
+
+std::size_t ActiveTouchTable::hash(int touchId)
+{
+    // Touch ids are small path indices with the device id in the high bits.
+    uint32_t key = static_cast<uint32_t>(touchId);
+    key ^= key >> 16;
+    key *= 0x9E3779B1u;
+    return (key >> 24) & INDEX_MASK;
+}
+
+
+std::size_t ActiveTouchTable::probe(int touchId) const
+{
+    // The index is never more than half full, so an empty entry is always
+    // found.
+    std::size_t i = hash(touchId);
+
+    while (_index[i] != EMPTY && _touches[_index[i]].id != touchId)
+    {
+        i = (i + 1) & INDEX_MASK;
+    }
+
+    return i;
+}
+
+
+} // namespace ofx
@@ -0,0 +1,365 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/ContactFrameQueue.h"
+#include <thread>
+
+
+namespace ofx {
+
+
+namespace {
+
+
+std::size_t nextPowerOfTwo(std::size_t value)
+{
+    std::size_t size = 2;
+
+    while (size < value)
+    {
+        size <<= 1;
+    }
+
+    return size;
+}
+
+
+} // namespace
+
+
+ContactFrameQueue::ContactFrameQueue(std::size_t capacity):
+    _slots(nextPowerOfTwo(capacity)),
+    _mask(_slots.size() - 1),
+    _enqueuePosition(0),
+    _dequeuePosition(0),
+    _overflowState(OVERFLOW_EMPTY),
+    _overflowPolicy(DROP_OLDEST),
+    _overflowCount(0),
+    _droppedFrameCount(0),
+    _coalescedFrameCount(0)
+{
+    for (std::size_t i = 0; i < _slots.size(); ++i)
+    {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+
+ContactFrameQueue::~ContactFrameQueue()
+{
+}
+
+
+bool ContactFrameQueue::push(const ContactFrame& frame)
+{
+    if (getOverflowPolicy() == COALESCE_MOVES)
+    {
+        return pushCoalesced(frame);
+    }
+
+    if (tryPush(frame))
+    {
+        return true;
+    }
+
+    _overflowCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (tryPop(nullptr))
+    {
+        _droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+
+        if (tryPush(frame))
+        {
+            return true;
+        }
+    }
+
+    // The consumer is still holding the slot we need.
+    _droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+
+bool ContactFrameQueue::pushCoalesced(const ContactFrame& frame)
+{
+    bool isOverflowing = false;
+
+    while (true)
+    {
+        // While an overflow frame is pending, newer frames must be merged
+        // into it so that they are not delivered ahead of it.
+        int expected = OVERFLOW_READY;
+
+        if (_overflowState.compare_exchange_strong(expected,
+                                                   OVERFLOW_WRITING,
+                                                   std::memory_order_acquire))
+        {
+            coalesce(_overflowFrame, frame);
+            _overflowState.store(OVERFLOW_READY, std::memory_order_release);
+            _coalescedFrameCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        if (expected == OVERFLOW_EMPTY)
+        {
+            if (tryPush(frame))
+            {
+                return true;
+            }
+
+            if (!isOverflowing)
+            {
+                isOverflowing = true;
+                _overflowCount.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            expected = OVERFLOW_EMPTY;
+
+            if (_overflowState.compare_exchange_strong(expected,
+                                                       OVERFLOW_WRITING,
+                                                       std::memory_order_acquire))
+            {
+                _overflowFrame = frame;
+                _overflowState.store(OVERFLOW_READY, std::memory_order_release);
+                return true;
+            }
+        }
+
+        // Another producer is writing the overflow frame, or the consumer is
+        // reading it. Falling through to the ring here could let this frame
+        // overtake the overflow frame, so wait and try again.
+        std::this_thread::yield();
+    }
+}
+
+
+bool ContactFrameQueue::pop(ContactFrame& frame)
+{
+    if (tryPop(&frame))
+    {
+        return true;
+    }
+
+    // The overflow frame is newer than anything in the ring.
+    int expected = OVERFLOW_READY;
+
+    if (_overflowState.compare_exchange_strong(expected,
+                                               OVERFLOW_READING,
+                                               std::memory_order_acquire))
+    {
+        // A producer may have pushed a frame to the ring before merging
+        // newer ones into the overflow frame, so it has to go first.
+        if (_enqueuePosition.load(std::memory_order_acquire) != _dequeuePosition.load(std::memory_order_relaxed))
+        {
+            _overflowState.store(OVERFLOW_READY, std::memory_order_release);
+            return tryPop(&frame);
+        }
+
+        frame = _overflowFrame;
+        _overflowState.store(OVERFLOW_EMPTY, std::memory_order_release);
+        return true;
+    }
+
+    return false;
+}
+
+
+std::size_t ContactFrameQueue::size() const
+{
+    std::size_t enqueued = _enqueuePosition.load(std::memory_order_relaxed);
+    std::size_t dequeued = _dequeuePosition.load(std::memory_order_relaxed);
+    std::size_t size = enqueued > dequeued ? enqueued - dequeued : 0;
+
+    if (_overflowState.load(std::memory_order_relaxed) == OVERFLOW_READY)
+    {
+        ++size;
+    }
+
+    return size;
+}
+
+
+std::size_t ContactFrameQueue::capacity() const
+{
+    return _slots.size();
+}
+
+
+ContactFrameQueue::OverflowPolicy ContactFrameQueue::getOverflowPolicy() const
+{
+    return static_cast<OverflowPolicy>(_overflowPolicy.load(std::memory_order_relaxed));
+}
+
+
+void ContactFrameQueue::setOverflowPolicy(OverflowPolicy policy)
+{
+    _overflowPolicy.store(policy, std::memory_order_relaxed);
+}
+
+
+uint64_t ContactFrameQueue::overflowCount() const
+{
+    return _overflowCount.load(std::memory_order_relaxed);
+}
+
+
+uint64_t ContactFrameQueue::droppedFrameCount() const
+{
+    return _droppedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+uint64_t ContactFrameQueue::coalescedFrameCount() const
+{
+    return _coalescedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+bool ContactFrameQueue::tryPush(const ContactFrame& frame)
+{
+    // Several producers may push, so the enqueue position is claimed with a
+    // CAS before the slot is written.
+    std::size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Slot& slot = _slots[position & _mask];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+        if (diff == 0)
+        {
+            if (_enqueuePosition.compare_exchange_weak(position,
+                                                       position + 1,
+                                                       std::memory_order_relaxed))
+            {
+                slot.frame = frame;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Full, or the slot is still being read.
+            return false;
+        }
+        else
+        {
+            position = _enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+bool ContactFrameQueue::tryPop(ContactFrame* frame)
+{
+    // The consumer and the producers (when dropping the oldest frame) may all
+    // dequeue, so the dequeue position is claimed with a CAS.
+    std::size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        Slot& slot = _slots[position & _mask];
+        std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+        if (diff == 0)
+        {
+            if (_dequeuePosition.compare_exchange_weak(position,
+                                                       position + 1,
+                                                       std::memory_order_relaxed))
+            {
+                if (frame != nullptr)
+                {
+                    *frame = slot.frame;
+                }
+
+                slot.sequence.store(position + _mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = _dequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+
+void ContactFrameQueue::coalesce(ContactFrame& older, const ContactFrame& newer)
+{
+    coalesce(older.touches, newer.touches, older.timestamp, &older.history);
+    coalesce(older.hovers, newer.hovers, older.timestamp, nullptr);
+
+    // The newer history comes after every position in the older frame.
+    for (const auto& sample: newer.history)
+    {
+        older.history.push_back(sample);
+    }
+
+    // The receivedTime of the oldest frame is kept, so delivery latency
+    // includes the wait of every merged frame.
+    older.deviceId = newer.deviceId;
+    older.timestamp = newer.timestamp;
+    older.frameNum = newer.frameNum;
+}
+
+
+void ContactFrameQueue::coalesce(TouchBuffer& older,
+                                 const TouchBuffer& newer,
+                                 double timestamp,
+                                 TouchHistory* history)
+{
+    for (std::size_t j = 0; j < newer.size(); ++j)
+    {
+        const ofTouchEventArgs& touch = newer[j];
+        bool merged = false;
+
+        if (touch.type == ofTouchEventArgs::move)
+        {
+            // Only the latest entry for a touch may be replaced, so that down
+            // and up boundaries are kept.
+            for (std::size_t i = older.size(); i-- > 0;)
+            {
+                if (older[i].id == touch.id)
+                {
+                    if (older[i].type == ofTouchEventArgs::move)
+                    {
+                        if (history != nullptr)
+                        {
+                            TouchHistory::Sample sample;
+                            sample.id = touch.id;
+                            sample.x = older[i].x;
+                            sample.y = older[i].y;
+                            sample.timestamp = timestamp;
+                            history->push_back(sample);
+                        }
+
+                        older[i] = touch;
+                        older.predicted(i) = newer.predicted(j);
+                        merged = true;
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        if (!merged)
+        {
+            // Touches beyond the buffer capacity are dropped.
+            older.push_back(touch, newer.predicted(j));
+        }
+    }
+}
+
+
+} // namespace ofx
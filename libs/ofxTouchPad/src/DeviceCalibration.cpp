@@ -0,0 +1,134 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/DeviceCalibration.h"
+
+
+namespace ofx {
+
+
+DeviceCalibration::DeviceCalibration()
+{
+}
+
+
+void DeviceCalibration::extend(const TouchFrame& frame)
+{
+    Bounds bounds = _bounds.load();
+    Bounds extended = bounds;
+
+    frame.extendBounds(extended.minX, extended.minY, extended.maxX, extended.maxY);
+
+    if (extended.minX == bounds.minX
+     && extended.minY == bounds.minY
+     && extended.maxX == bounds.maxX
+     && extended.maxY == bounds.maxY)
+    {
+        return;
+    }
+
+    // Extend the latest bounds, in case they were replaced meanwhile.
+    _bounds.update([&](Bounds& latest)
+    {
+        frame.extendBounds(latest.minX, latest.minY, latest.maxX, latest.maxY);
+    });
+}
+
+
+void DeviceCalibration::apply(TouchFrameTransform& transform) const
+{
+    Bounds bounds = _bounds.load();
+    transform.minX = bounds.minX;
+    transform.minY = bounds.minY;
+    transform.maxX = bounds.maxX;
+    transform.maxY = bounds.maxY;
+}
+
+
+void DeviceCalibration::reset()
+{
+    set(0, 0, 1, 1);
+}
+
+
+void DeviceCalibration::set(float minX, float minY, float maxX, float maxY)
+{
+    Bounds bounds;
+    bounds.minX = minX;
+    bounds.minY = minY;
+    bounds.maxX = maxX;
+    bounds.maxY = maxY;
+    _bounds.store(bounds);
+}
+
+
+float DeviceCalibration::minX() const
+{
+    return _bounds.load().minX;
+}
+
+
+float DeviceCalibration::minY() const
+{
+    return _bounds.load().minY;
+}
+
+
+float DeviceCalibration::maxX() const
+{
+    return _bounds.load().maxX;
+}
+
+
+float DeviceCalibration::maxY() const
+{
+    return _bounds.load().maxY;
+}
+
+
+ofJson DeviceCalibration::toJson() const
+{
+    Bounds bounds = _bounds.load();
+
+    ofJson json;
+    json["minX"] = bounds.minX;
+    json["minY"] = bounds.minY;
+    json["maxX"] = bounds.maxX;
+    json["maxY"] = bounds.maxY;
+    return json;
+}
+
+
+bool DeviceCalibration::fromJson(const ofJson& json)
+{
+    // Check the types first, so a malformed file is rejected rather than
+    // throwing.
+    if (!json.is_object()
+     || json.count("minX") == 0 || !json["minX"].is_number()
+     || json.count("minY") == 0 || !json["minY"].is_number()
+     || json.count("maxX") == 0 || !json["maxX"].is_number()
+     || json.count("maxY") == 0 || !json["maxY"].is_number())
+    {
+        return false;
+    }
+
+    float minX = json["minX"].get<float>();
+    float minY = json["minY"].get<float>();
+    float maxX = json["maxX"].get<float>();
+    float maxY = json["maxY"].get<float>();
+
+    if (!(maxX > minX) || !(maxY > minY))
+    {
+        return false;
+    }
+
+    set(minX, minY, maxX, maxY);
+    return true;
+}
+
+
+} // namespace ofx
@@ -0,0 +1,317 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/DeviceManager.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include "ofLog.h"
+
+
+namespace ofx {
+
+
+DeviceManager::DeviceManager():
+    _isRunning(false)
+{
+}
+
+
+DeviceManager::~DeviceManager()
+{
+    stop();
+}
+
+
+bool DeviceManager::start(const DeviceManagerSettings& settings,
+                          ScanFunction scan,
+                          DeviceFunction connect,
+                          DeviceFunction disconnect)
+{
+    if (_thread.joinable())
+    {
+        ofLogWarning("DeviceManager::start") << "The device manager is already running.";
+        return false;
+    }
+
+    _settings = settings;
+    _scan = scan;
+    _connect = connect;
+    _disconnect = disconnect;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _devices.clear();
+        _commands.clear();
+        _isRefreshRequested = true;
+        _isRunning = true;
+    }
+
+    _thread = std::thread(&DeviceManager::run, this);
+
+    return true;
+}
+
+
+void DeviceManager::stop()
+{
+    if (!_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _isRunning = false;
+        _condition.notify_all();
+    }
+
+    _thread.join();
+}
+
+
+bool DeviceManager::isRunning() const
+{
+    return _isRunning.load();
+}
+
+
+DeviceManagerSettings DeviceManager::settings() const
+{
+    return _settings;
+}
+
+
+void DeviceManager::refresh()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _isRefreshRequested = true;
+    _condition.notify_all();
+}
+
+
+void DeviceManager::connect(int deviceId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _commands.push_back({ true, deviceId });
+    _condition.notify_all();
+}
+
+
+void DeviceManager::disconnect(int deviceId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _commands.push_back({ false, deviceId });
+    _condition.notify_all();
+}
+
+
+void DeviceManager::setConnectionWanted(int deviceId, bool isWanted)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (isWanted)
+    {
+        _unwantedDeviceIds.erase(deviceId);
+    }
+    else
+    {
+        _unwantedDeviceIds.insert(deviceId);
+    }
+}
+
+
+std::vector<DeviceEventArgs> DeviceManager::devices() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _devices;
+}
+
+
+void DeviceManager::post(EventType type, const DeviceEventArgs& args)
+{
+    std::unique_lock<std::mutex> lock(_eventMutex);
+    _events.push_back({ type, args });
+}
+
+
+void DeviceManager::update(DeviceEvents& events)
+{
+    {
+        std::unique_lock<std::mutex> lock(_eventMutex);
+
+        if (_events.empty())
+        {
+            return;
+        }
+
+        _firingEvents.swap(_events);
+    }
+
+    for (const auto& event: _firingEvents)
+    {
+        switch (event.type)
+        {
+            case DEVICE_ADDED:
+                ofNotifyEvent(events.added, event.args);
+                break;
+            case DEVICE_REMOVED:
+                ofNotifyEvent(events.removed, event.args);
+                break;
+            case DEVICE_CONNECTED:
+                ofNotifyEvent(events.connected, event.args);
+                break;
+            case DEVICE_DISCONNECTED:
+                ofNotifyEvent(events.disconnected, event.args);
+                break;
+        }
+    }
+
+    _firingEvents.clear();
+}
+
+
+void DeviceManager::run()
+{
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(_settings.pollInterval, 0.01)));
+
+    auto nextScan = std::chrono::steady_clock::now();
+
+    std::vector<Command> commands;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        auto isReady = [this]()
+        {
+            return !_isRunning || _isRefreshRequested || !_commands.empty();
+        };
+
+        if (_settings.watch)
+        {
+            _condition.wait_until(lock, nextScan, isReady);
+        }
+        else
+        {
+            _condition.wait(lock, isReady);
+        }
+
+        if (!_isRunning)
+        {
+            break;
+        }
+
+        bool isScanDue = _isRefreshRequested
+                      || (_settings.watch && std::chrono::steady_clock::now() >= nextScan);
+
+        _isRefreshRequested = false;
+        commands.swap(_commands);
+
+        // The backend is called without the lock so requests never wait
+        // for it.
+        lock.unlock();
+
+        if (isScanDue)
+        {
+            scan();
+            nextScan = std::chrono::steady_clock::now() + interval;
+        }
+
+        for (const auto& command: commands)
+        {
+            if (command.isConnect)
+            {
+                _connect(command.deviceId);
+            }
+            else
+            {
+                _disconnect(command.deviceId);
+            }
+        }
+
+        commands.clear();
+
+        lock.lock();
+    }
+}
+
+
+void DeviceManager::scan()
+{
+    std::vector<DeviceEventArgs> present = _scan();
+
+    std::sort(present.begin(), present.end(), [](const DeviceEventArgs& a, const DeviceEventArgs& b)
+    {
+        return a.deviceId < b.deviceId;
+    });
+
+    std::vector<DeviceEventArgs> added;
+    std::vector<DeviceEventArgs> removed;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto isLess = [](const DeviceEventArgs& a, const DeviceEventArgs& b)
+        {
+            return a.deviceId < b.deviceId;
+        };
+
+        std::set_difference(present.begin(), present.end(),
+                            _devices.begin(), _devices.end(),
+                            std::back_inserter(added), isLess);
+
+        std::set_difference(_devices.begin(), _devices.end(),
+                            present.begin(), present.end(),
+                            std::back_inserter(removed), isLess);
+
+        // The ids alone don't show a device that was unplugged and plugged
+        // back in between scans, but its lost connection does.
+        for (const auto& device: present)
+        {
+            auto previous = std::lower_bound(_devices.begin(), _devices.end(), device, isLess);
+
+            if (previous != _devices.end()
+             && previous->deviceId == device.deviceId
+             && previous->isConnected
+             && !device.isConnected
+             && _unwantedDeviceIds.count(device.deviceId) == 0)
+            {
+                ofLogVerbose("DeviceManager::scan") << device.name << " was plugged back in.";
+                removed.push_back(*previous);
+                added.push_back(device);
+            }
+        }
+
+        _devices = present;
+    }
+
+    for (const auto& device: removed)
+    {
+        ofLogVerbose("DeviceManager::scan") << "Removed " << device.name << ".";
+        _disconnect(device.deviceId);
+        post(DEVICE_REMOVED, device);
+    }
+
+    for (const auto& device: added)
+    {
+        ofLogVerbose("DeviceManager::scan") << "Added " << device.name << ".";
+        post(DEVICE_ADDED, device);
+
+        const std::vector<int>& ids = _settings.autoConnectDeviceIds;
+
+        if (_settings.autoConnect
+         && (ids.empty() || std::find(ids.begin(), ids.end(), device.deviceId) != ids.end()))
+        {
+            _connect(device.deviceId);
+        }
+    }
+}
+
+
+} // namespace ofx
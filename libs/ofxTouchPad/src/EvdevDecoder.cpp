@@ -0,0 +1,305 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/EvdevDecoder.h"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "ofLog.h"
+#include "ofMath.h"
+#include "ofUtils.h"
+
+
+namespace ofx {
+
+
+EvdevDecoder::EvdevDecoder()
+{
+}
+
+
+void EvdevDecoder::setAxis(uint16_t code, const EvdevAxis& axis)
+{
+    if (code < ABS_COUNT)
+    {
+        _axes[code] = axis;
+    }
+}
+
+
+const EvdevAxis& EvdevDecoder::axis(uint16_t code) const
+{
+    return _axes[code < ABS_COUNT ? code : 0];
+}
+
+
+void EvdevDecoder::setFrameCallback(FrameCallback callback)
+{
+    _frameCallback = callback;
+}
+
+
+void EvdevDecoder::decode(const EvdevEvent& event)
+{
+    if (event.type == TYPE_SYN)
+    {
+        if (event.code == CODE_SYN_REPORT)
+        {
+            if (_isDropping)
+            {
+                _isDropping = false;
+            }
+            else
+            {
+                report(event.timestamp);
+            }
+        }
+        else if (event.code == CODE_SYN_DROPPED)
+        {
+            _isDropping = true;
+        }
+
+        return;
+    }
+
+    if (_isDropping || event.type != TYPE_ABS)
+    {
+        return;
+    }
+
+    if (event.code == CODE_MT_SLOT)
+    {
+        _slot = event.value >= 0 && event.value < MAX_SLOTS ? event.value : -1;
+        return;
+    }
+
+    if (_slot < 0)
+    {
+        // Fingers beyond MAX_SLOTS are ignored.
+        return;
+    }
+
+    Slot& slot = _slots[_slot];
+
+    switch (event.code)
+    {
+        case CODE_MT_TRACKING_ID:
+            slot.trackingId = event.value;
+            break;
+        case CODE_MT_POSITION_X:
+            slot.x = event.value;
+            break;
+        case CODE_MT_POSITION_Y:
+            slot.y = event.value;
+            break;
+        case CODE_MT_TOUCH_MAJOR:
+            slot.touchMajor = event.value;
+            break;
+        case CODE_MT_TOUCH_MINOR:
+            slot.touchMinor = event.value;
+            break;
+        case CODE_MT_ORIENTATION:
+            slot.orientation = event.value;
+            break;
+        case CODE_MT_PRESSURE:
+            slot.pressure = event.value;
+            break;
+        default:
+            break;
+    }
+}
+
+
+void EvdevDecoder::reset()
+{
+    for (auto& slot: _slots)
+    {
+        slot = Slot();
+    }
+
+    _slot = 0;
+    _isDropping = false;
+}
+
+
+void EvdevDecoder::report(double timestamp)
+{
+    int32_t numTouches = 0;
+
+    for (auto& slot: _slots)
+    {
+        if (slot.reportedId >= 0 && slot.reportedId != slot.trackingId)
+        {
+            // The finger lifted, or the slot was reused by another finger
+            // within the frame.
+            MTTouch& touch = _touches[numTouches++];
+            touch = slot.reported;
+            touch.frame = _frameNum;
+            touch.timestamp = timestamp;
+            touch.phase = MTTouchStateOutOfRange;
+        }
+
+        if (slot.trackingId >= 0)
+        {
+            MTTouchPhase phase = slot.reportedId == slot.trackingId ? MTTouchStateTouching : MTTouchStateMakeTouch;
+            slot.reported = toTouch(slot, phase, timestamp);
+            _touches[numTouches++] = slot.reported;
+        }
+
+        slot.reportedId = slot.trackingId;
+    }
+
+    if (_frameCallback)
+    {
+        _frameCallback(_touches.data(), numTouches, timestamp, _frameNum);
+    }
+
+    ++_frameNum;
+}
+
+
+MTTouch EvdevDecoder::toTouch(const Slot& slot, MTTouchPhase phase, double timestamp) const
+{
+    MTTouch touch;
+    std::memset(&touch, 0, sizeof(MTTouch));
+
+    touch.frame = _frameNum;
+    touch.timestamp = timestamp;
+    touch.pathIndex = slot.trackingId;
+    touch.phase = phase;
+    touch.fingerID = static_cast<int32_t>(&slot - _slots.data());
+    touch.handID = 1;
+
+    // Evdev's origin is at the top left.
+    touch.normalizedVector.position.x = normalize(CODE_MT_POSITION_X, slot.x);
+    touch.normalizedVector.position.y = 1.0f - normalize(CODE_MT_POSITION_Y, slot.y);
+
+    const EvdevAxis& y = axis(CODE_MT_POSITION_Y);
+    touch.absoluteVector.position.x = millimeters(CODE_MT_POSITION_X, slot.x - axis(CODE_MT_POSITION_X).minimum);
+    touch.absoluteVector.position.y = millimeters(CODE_MT_POSITION_Y, y.maximum - slot.y);
+
+    // Contact sizes are in the units of the position axes.
+    touch.majorAxis = millimeters(CODE_MT_POSITION_X, slot.touchMajor);
+    touch.minorAxis = millimeters(CODE_MT_POSITION_X, slot.touchMinor > 0 ? slot.touchMinor : slot.touchMajor);
+
+    // The orientation range spans a quarter turn either side of vertical.
+    const EvdevAxis& orientation = axis(CODE_MT_ORIENTATION);
+
+    if (orientation.maximum > 0)
+    {
+        touch.angle = glm::pi<float>() / 2 * (1.0f + float(slot.orientation) / orientation.maximum);
+    }
+    else
+    {
+        touch.angle = glm::pi<float>() / 2;
+    }
+
+    touch.zTotal = axis(CODE_MT_PRESSURE).isValid() ? normalize(CODE_MT_PRESSURE, slot.pressure) : 0.5f;
+
+    return touch;
+}
+
+
+float EvdevDecoder::normalize(uint16_t code, int32_t value) const
+{
+    const EvdevAxis& range = axis(code);
+
+    if (!range.isValid())
+    {
+        return 0;
+    }
+
+    return float(value - range.minimum) / float(range.maximum - range.minimum);
+}
+
+
+float EvdevDecoder::millimeters(uint16_t code, int32_t value) const
+{
+    const EvdevAxis& range = axis(code);
+    return range.resolution > 0 ? float(value) / range.resolution : float(value);
+}
+
+
+bool EvdevRecording::load(const std::string& path)
+{
+    std::ifstream stream(ofToDataPath(path, true));
+
+    if (!stream)
+    {
+        ofLogError("EvdevRecording::load") << "Unable to open " << path << ".";
+        return false;
+    }
+
+    name.clear();
+    axes.assign(EvdevDecoder::ABS_COUNT, EvdevAxis());
+    events.clear();
+
+    std::string line;
+
+    while (std::getline(stream, line))
+    {
+        if (line.compare(0, 3, "N: ") == 0)
+        {
+            name = line.substr(3);
+        }
+        else if (line.compare(0, 3, "A: ") == 0)
+        {
+            // A: <code> <min> <max> <fuzz> <flat> [<resolution>]
+            std::istringstream fields(line.substr(3));
+            unsigned int code = 0;
+            int32_t fuzz = 0;
+            int32_t flat = 0;
+            EvdevAxis axis;
+
+            if (fields >> std::hex >> code >> std::dec >> axis.minimum >> axis.maximum >> fuzz >> flat
+             && code < axes.size())
+            {
+                fields >> axis.resolution;
+                axes[code] = axis;
+            }
+        }
+        else if (line.compare(0, 3, "E: ") == 0)
+        {
+            // E: <sec>.<usec> <type> <code> <value>
+            std::istringstream fields(line.substr(3));
+            EvdevEvent event;
+            unsigned int type = 0;
+            unsigned int code = 0;
+
+            if (fields >> event.timestamp >> std::hex >> type >> code >> std::dec >> event.value)
+            {
+                event.type = static_cast<uint16_t>(type);
+                event.code = static_cast<uint16_t>(code);
+                events.push_back(event);
+            }
+            else
+            {
+                ofLogWarning("EvdevRecording::load") << "Skipping malformed event: " << line;
+            }
+        }
+    }
+
+    if (events.empty())
+    {
+        ofLogError("EvdevRecording::load") << "No events in " << path << ".";
+        return false;
+    }
+
+    return true;
+}
+
+
+void EvdevRecording::configure(EvdevDecoder& decoder) const
+{
+    for (std::size_t i = 0; i < axes.size(); ++i)
+    {
+        decoder.setAxis(static_cast<uint16_t>(i), axes[i]);
+    }
+}
+
+
+} // namespace ofx
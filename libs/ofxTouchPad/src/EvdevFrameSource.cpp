@@ -0,0 +1,641 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/EvdevFrameSource.h"
+
+
+#if defined(__linux__)
+
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "ofLog.h"
+
+
+namespace ofx {
+
+
+static_assert(EvdevDecoder::TYPE_SYN == EV_SYN && EvdevDecoder::TYPE_ABS == EV_ABS, "Event types differ.");
+static_assert(EvdevDecoder::CODE_SYN_REPORT == SYN_REPORT && EvdevDecoder::CODE_SYN_DROPPED == SYN_DROPPED, "SYN codes differ.");
+static_assert(EvdevDecoder::CODE_MT_SLOT == ABS_MT_SLOT
+           && EvdevDecoder::CODE_MT_TOUCH_MAJOR == ABS_MT_TOUCH_MAJOR
+           && EvdevDecoder::CODE_MT_TOUCH_MINOR == ABS_MT_TOUCH_MINOR
+           && EvdevDecoder::CODE_MT_ORIENTATION == ABS_MT_ORIENTATION
+           && EvdevDecoder::CODE_MT_POSITION_X == ABS_MT_POSITION_X
+           && EvdevDecoder::CODE_MT_POSITION_Y == ABS_MT_POSITION_Y
+           && EvdevDecoder::CODE_MT_TRACKING_ID == ABS_MT_TRACKING_ID
+           && EvdevDecoder::CODE_MT_PRESSURE == ABS_MT_PRESSURE, "ABS codes differ.");
+static_assert(EvdevDecoder::ABS_COUNT == ABS_CNT, "ABS_CNT differs.");
+
+
+namespace {
+
+
+bool testBit(const std::vector<unsigned long>& bits, std::size_t bit)
+{
+    const std::size_t bitsPerLong = sizeof(unsigned long) * 8;
+    return (bits[bit / bitsPerLong] >> (bit % bitsPerLong)) & 1;
+}
+
+
+} // namespace
+
+
+EvdevFrameSource::EvdevFrameSource(const std::vector<std::string>& devicePaths):
+    _devicePaths(devicePaths),
+    _isRunning(false)
+{
+}
+
+
+EvdevFrameSource::~EvdevFrameSource()
+{
+    for (std::size_t i = 0; i < _devices.size(); ++i)
+    {
+        if (isConnected(i))
+        {
+            disconnect(i);
+        }
+    }
+
+    stopThread();
+}
+
+
+std::string EvdevFrameSource::name() const
+{
+    return "Evdev";
+}
+
+
+void EvdevFrameSource::refreshDeviceList()
+{
+    std::vector<std::string> paths = _devicePaths;
+
+    if (paths.empty())
+    {
+        DIR* dir = opendir("/dev/input");
+
+        if (dir == nullptr)
+        {
+            ofLogError("EvdevFrameSource::refreshDeviceList") << "Unable to open /dev/input: " << std::strerror(errno);
+            return;
+        }
+
+        while (dirent* entry = readdir(dir))
+        {
+            if (std::strncmp(entry->d_name, "event", 5) == 0)
+            {
+                paths.push_back(std::string("/dev/input/") + entry->d_name);
+            }
+        }
+
+        closedir(dir);
+
+        // Number new devices in the order of their nodes.
+        std::sort(paths.begin(), paths.end(), [](const std::string& a, const std::string& b)
+        {
+            return a.size() != b.size() ? a.size() < b.size() : a < b;
+        });
+    }
+
+    // Probe the nodes without the lock, so the read thread isn't stalled.
+    std::vector<std::unique_ptr<Device>> probed;
+
+    for (const auto& path: paths)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+
+        if (fd < 0)
+        {
+            ofLogVerbose("EvdevFrameSource::refreshDeviceList") << "Unable to open " << path << ": " << std::strerror(errno);
+            continue;
+        }
+
+        std::unique_ptr<Device> device(new Device());
+        device->path = path;
+        device->isPresent = true;
+
+        if (readDeviceInfo(fd, *device))
+        {
+            probed.push_back(std::move(device));
+        }
+
+        ::close(fd);
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+
+    std::vector<bool> found(_devices.size(), false);
+
+    for (auto& device: probed)
+    {
+        auto iter = std::find_if(_devices.begin(), _devices.end(), [&](const std::unique_ptr<Device>& known)
+        {
+            return known->identity == device->identity;
+        });
+
+        if (iter == _devices.end())
+        {
+            ofLogVerbose("EvdevFrameSource::refreshDeviceList") << "Found " << device->name << " at " << device->path << ".";
+            _devices.push_back(std::move(device));
+            found.push_back(true);
+        }
+        else
+        {
+            // A device that was plugged back in may have a new node.
+            if ((*iter)->fd < 0)
+            {
+                (*iter)->path = device->path;
+                (*iter)->decoder = device->decoder;
+            }
+
+            (*iter)->isPresent = true;
+            found[iter - _devices.begin()] = true;
+        }
+    }
+
+    for (std::size_t i = 0; i < _devices.size(); ++i)
+    {
+        _devices[i]->isPresent = found[i];
+    }
+
+    ofLogVerbose("EvdevFrameSource::refreshDeviceList") << "Found " << _devices.size() << " multitouch devices.";
+}
+
+
+std::size_t EvdevFrameSource::numDevices() const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return _devices.size();
+}
+
+
+bool EvdevFrameSource::isPresent(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_devices.size()) && _devices[deviceId]->isPresent;
+}
+
+
+std::string EvdevFrameSource::deviceIdentity(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_devices.size()) ? _devices[deviceId]->identity : "";
+}
+
+
+bool EvdevFrameSource::connect(int deviceId)
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+
+    if (deviceId < 0 || deviceId >= static_cast<int>(_devices.size()) || !_devices[deviceId]->isPresent)
+    {
+        ofLogWarning("EvdevFrameSource::connect") << "No multitouch device with id " << deviceId << ".";
+        return false;
+    }
+
+    Device& device = *_devices[deviceId];
+
+    if (device.fd >= 0)
+    {
+        ofLogWarning("EvdevFrameSource::connect") << "Already connected to device " << deviceId << ".";
+        return false;
+    }
+
+    int fd = ::open(device.path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+
+    if (fd < 0)
+    {
+        ofLogError("EvdevFrameSource::connect") << "Unable to open " << device.path << ": " << std::strerror(errno);
+        return false;
+    }
+
+    // Timestamp events with the steady clock rather than the wall clock.
+    int clockId = CLOCK_MONOTONIC;
+
+    device.hasMonotonicTimestamps = ioctl(fd, EVIOCSCLOCKID, &clockId) >= 0;
+
+    if (!device.hasMonotonicTimestamps)
+    {
+        ofLogWarning("EvdevFrameSource::connect") << "Unable to use monotonic timestamps for " << device.path << ": " << std::strerror(errno) << ". Events will be stamped as they are read.";
+    }
+
+    startThread();
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = static_cast<uint32_t>(deviceId);
+
+    if (_epollFd < 0 || epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        ofLogError("EvdevFrameSource::connect") << "Unable to watch " << device.path << ": " << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    device.fd = fd;
+    device.isDropping = false;
+    device.isDeferring = false;
+    device.deferredFrame.isPending = false;
+    ++device.connection;
+    device.decoder.reset();
+    device.decoder.setFrameCallback([this, deviceId](const MTTouch* touches,
+                                                     int32_t numTouches,
+                                                     double timestamp,
+                                                     int32_t frameNum)
+    {
+        // The decoder only runs under the lock.
+        Device& device = *_devices[deviceId];
+
+        if (device.isDeferring)
+        {
+            auto& frame = device.deferredFrame;
+            frame.numTouches = std::min(numTouches, static_cast<int32_t>(frame.touches.size()));
+            std::copy(touches, touches + frame.numTouches, frame.touches.begin());
+            frame.timestamp = timestamp;
+            frame.frameNum = frameNum;
+            frame.isPending = true;
+            return;
+        }
+
+        notifyFrame(deviceId, touches, numTouches, timestamp, frameNum);
+    });
+
+    // Begin the contacts that are already down.
+    resync(device);
+
+    return true;
+}
+
+
+bool EvdevFrameSource::disconnect(int deviceId)
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+
+    if (!isConnected(deviceId))
+    {
+        ofLogWarning("EvdevFrameSource::disconnect") << "Not connected to device " << deviceId << ".";
+        return false;
+    }
+
+    Device& device = *_devices[deviceId];
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, device.fd, nullptr);
+    ::close(device.fd);
+    device.fd = -1;
+    return true;
+}
+
+
+bool EvdevFrameSource::isConnected(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_devices.size()) && _devices[deviceId]->fd >= 0;
+}
+
+
+bool EvdevFrameSource::hasSteadyTimestamps() const
+{
+    return true;
+}
+
+
+std::string EvdevFrameSource::devicePath(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_devices.size()) ? _devices[deviceId]->path : "";
+}
+
+
+std::string EvdevFrameSource::deviceName(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_devices.size()) ? _devices[deviceId]->name : "";
+}
+
+
+bool EvdevFrameSource::readDeviceInfo(int fd, Device& device)
+{
+    const std::size_t bitsPerLong = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> absBits((ABS_CNT + bitsPerLong - 1) / bitsPerLong, 0);
+
+    if (ioctl(fd, EVIOCGBIT(EV_ABS, absBits.size() * sizeof(unsigned long)), absBits.data()) < 0
+     || !testBit(absBits, ABS_MT_SLOT)
+     || !testBit(absBits, ABS_MT_TRACKING_ID)
+     || !testBit(absBits, ABS_MT_POSITION_X)
+     || !testBit(absBits, ABS_MT_POSITION_Y))
+    {
+        return false;
+    }
+
+    char name[256] = { 0 };
+
+    if (ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name) >= 0)
+    {
+        device.name = name;
+    }
+
+    // Prefer the unique id (e.g. a serial number), then the physical
+    // location, then the node.
+    char uniq[256] = { 0 };
+    char phys[256] = { 0 };
+
+    if (ioctl(fd, EVIOCGUNIQ(sizeof(uniq) - 1), uniq) >= 0 && uniq[0] != 0)
+    {
+        device.identity = device.name + "/" + uniq;
+    }
+    else if (ioctl(fd, EVIOCGPHYS(sizeof(phys) - 1), phys) >= 0 && phys[0] != 0)
+    {
+        device.identity = device.name + "@" + phys;
+    }
+    else
+    {
+        device.identity = device.path;
+    }
+
+    for (uint16_t code = 0; code < ABS_CNT; ++code)
+    {
+        input_absinfo info;
+
+        if (testBit(absBits, code) && ioctl(fd, EVIOCGABS(code), &info) >= 0)
+        {
+            EvdevAxis axis;
+            axis.minimum = info.minimum;
+            axis.maximum = info.maximum;
+            axis.resolution = info.resolution;
+            device.decoder.setAxis(code, axis);
+        }
+    }
+
+    return true;
+}
+
+
+void EvdevFrameSource::resync(Device& device)
+{
+    // The kernel only fills the device's slots, so read no more than that.
+    input_absinfo slot;
+
+    if (ioctl(device.fd, EVIOCGABS(ABS_MT_SLOT), &slot) < 0)
+    {
+        ofLogWarning("EvdevFrameSource::resync") << "Unable to read the slots of " << device.path << ".";
+        return;
+    }
+
+    int numSlots = std::min(std::max(slot.maximum + 1, 0), static_cast<int>(EvdevDecoder::MAX_SLOTS));
+
+    // The layout EVIOCGMTSLOTS expects: a code followed by a value per slot.
+    std::vector<int32_t> values(1 + numSlots, 0);
+
+    const uint16_t codes[] = {
+        ABS_MT_TRACKING_ID,
+        ABS_MT_POSITION_X,
+        ABS_MT_POSITION_Y,
+        ABS_MT_TOUCH_MAJOR,
+        ABS_MT_TOUCH_MINOR,
+        ABS_MT_ORIENTATION,
+        ABS_MT_PRESSURE
+    };
+
+    EvdevEvent event;
+    event.type = EV_ABS;
+
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    event.timestamp = now.tv_sec + now.tv_nsec / 1e9;
+
+    for (auto code: codes)
+    {
+        // A tracking id of 0 would be a live contact, so empty slots are -1.
+        std::fill(values.begin(), values.end(), code == ABS_MT_TRACKING_ID ? -1 : 0);
+        values[0] = code;
+
+        if (ioctl(device.fd, EVIOCGMTSLOTS(values.size() * sizeof(int32_t)), values.data()) < 0)
+        {
+            continue;
+        }
+
+        for (int i = 0; i < numSlots; ++i)
+        {
+            event.code = ABS_MT_SLOT;
+            event.value = i;
+            device.decoder.decode(event);
+
+            event.code = code;
+            event.value = values[1 + i];
+            device.decoder.decode(event);
+        }
+    }
+
+    event.code = ABS_MT_SLOT;
+    event.value = slot.value;
+    device.decoder.decode(event);
+
+    event.type = EV_SYN;
+    event.code = SYN_REPORT;
+    event.value = 0;
+    device.decoder.decode(event);
+}
+
+
+void EvdevFrameSource::startThread()
+{
+    if (_isRunning)
+    {
+        return;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (_epollFd < 0 || _wakeFd < 0)
+    {
+        ofLogError("EvdevFrameSource::startThread") << "Unable to create the epoll loop: " << std::strerror(errno);
+        stopThread();
+        return;
+    }
+
+    epoll_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = UINT32_MAX;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event);
+
+    _isRunning = true;
+    _thread = std::thread(&EvdevFrameSource::readThread, this);
+}
+
+
+void EvdevFrameSource::stopThread()
+{
+    _isRunning = false;
+
+    if (_wakeFd >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = ::write(_wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    if (_epollFd >= 0)
+    {
+        ::close(_epollFd);
+        _epollFd = -1;
+    }
+
+    if (_wakeFd >= 0)
+    {
+        ::close(_wakeFd);
+        _wakeFd = -1;
+    }
+}
+
+
+void EvdevFrameSource::readThread()
+{
+    epoll_event events[8];
+
+    while (_isRunning)
+    {
+        int count = epoll_wait(_epollFd, events, 8, -1);
+
+        if (count < 0 && errno != EINTR)
+        {
+            ofLogError("EvdevFrameSource::readThread") << "epoll_wait failed: " << std::strerror(errno);
+            break;
+        }
+
+        for (int i = 0; i < count && _isRunning; ++i)
+        {
+            if (events[i].data.u32 != UINT32_MAX)
+            {
+                int deviceId = static_cast<int>(events[i].data.u32);
+
+                if (!readEvents(deviceId))
+                {
+                    ofLogWarning("EvdevFrameSource::readThread") << "Device " << deviceId << " was removed.";
+                    std::unique_lock<std::recursive_mutex> lock(_mutex);
+                    _devices[deviceId]->isPresent = false;
+                    disconnect(deviceId);
+                }
+            }
+        }
+    }
+}
+
+
+bool EvdevFrameSource::readEvents(int deviceId)
+{
+    std::unique_lock<std::recursive_mutex> lock(_mutex);
+
+    if (!isConnected(deviceId))
+    {
+        return true;
+    }
+
+    // Devices are never erased, so the device outlives the unlocked
+    // dispatch below. Its connection may not.
+    Device& device = *_devices[deviceId];
+    const uint64_t connection = device.connection;
+
+    auto isCurrent = [&]()
+    {
+        return device.fd >= 0 && device.connection == connection;
+    };
+
+    input_event buffer[64];
+
+    while (isCurrent())
+    {
+        ssize_t size = ::read(device.fd, buffer, sizeof(buffer));
+
+        if (size < 0)
+        {
+            // EAGAIN means every pending event was read.
+            return errno == EAGAIN || errno == EINTR;
+        }
+
+        if (size == 0)
+        {
+            return false;
+        }
+
+        std::size_t count = static_cast<std::size_t>(size) / sizeof(input_event);
+
+        // Without kernel timestamps from the monotonic clock, use the time
+        // of the read instead.
+        double readTime = 0;
+
+        if (!device.hasMonotonicTimestamps)
+        {
+            timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            readTime = now.tv_sec + now.tv_nsec / 1e9;
+        }
+
+        for (std::size_t i = 0; i < count && isCurrent(); ++i)
+        {
+            const input_event& in = buffer[i];
+
+            EvdevEvent event;
+            event.timestamp = device.hasMonotonicTimestamps ? in.input_event_sec + in.input_event_usec / 1e6 : readTime;
+            event.type = in.type;
+            event.code = in.code;
+            event.value = in.value;
+
+            device.isDeferring = true;
+            device.decoder.decode(event);
+
+            if (in.type == EV_SYN && in.code == SYN_DROPPED)
+            {
+                device.isDropping = true;
+            }
+            else if (in.type == EV_SYN && in.code == SYN_REPORT && device.isDropping)
+            {
+                // The decoder skipped up to here; read the state we missed.
+                device.isDropping = false;
+                resync(device);
+            }
+
+            device.isDeferring = false;
+
+            if (device.deferredFrame.isPending)
+            {
+                // Dispatch without the lock. Only this thread writes the
+                // deferred frame.
+                const auto& frame = device.deferredFrame;
+                device.deferredFrame.isPending = false;
+                lock.unlock();
+                notifyFrame(deviceId, frame.touches.data(), frame.numTouches, frame.timestamp, frame.frameNum);
+                lock.lock();
+            }
+        }
+    }
+
+    return true;
+}
+
+
+} // namespace ofx
+
+
+#endif // __linux__
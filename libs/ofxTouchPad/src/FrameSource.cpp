@@ -0,0 +1,196 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/FrameSource.h"
+#include <cstring>
+#include "ofLog.h"
+
+
+namespace ofx {
+
+
+SyntheticFrameSource::SyntheticFrameSource(std::size_t numDevices):
+    _present(0),
+    _connected(0)
+{
+    for (std::size_t i = 0; i < numDevices; ++i)
+    {
+        addDevice();
+    }
+}
+
+
+SyntheticFrameSource::~SyntheticFrameSource()
+{
+}
+
+
+std::string SyntheticFrameSource::name() const
+{
+    return "Synthetic";
+}
+
+
+void SyntheticFrameSource::refreshDeviceList()
+{
+}
+
+
+std::size_t SyntheticFrameSource::numDevices() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _identities.size();
+}
+
+
+bool SyntheticFrameSource::isPresent(int deviceId) const
+{
+    return deviceId >= 0
+        && deviceId < MAX_DEVICES
+        && (_present.load() & (uint64_t(1) << deviceId)) != 0;
+}
+
+
+std::string SyntheticFrameSource::deviceIdentity(int deviceId) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_identities.size()) ? _identities[deviceId] : "";
+}
+
+
+bool SyntheticFrameSource::connect(int deviceId)
+{
+    if (isPresent(deviceId))
+    {
+        uint64_t bit = uint64_t(1) << deviceId;
+
+        if ((_connected.fetch_or(bit) & bit) == 0)
+        {
+            return true;
+        }
+        else
+        {
+            ofLogWarning("SyntheticFrameSource::connect") << "Already connected to device " << deviceId << ".";
+            return false;
+        }
+    }
+    else
+    {
+        ofLogWarning("SyntheticFrameSource::connect") << "No device with id " << deviceId << ".";
+        return false;
+    }
+}
+
+
+bool SyntheticFrameSource::disconnect(int deviceId)
+{
+    if (isConnected(deviceId))
+    {
+        _connected.fetch_and(~(uint64_t(1) << deviceId));
+        return true;
+    }
+    else
+    {
+        ofLogWarning("SyntheticFrameSource::disconnect") << "Not connected to device " << deviceId << ".";
+        return false;
+    }
+}
+
+
+bool SyntheticFrameSource::isConnected(int deviceId) const
+{
+    return deviceId >= 0
+        && deviceId < MAX_DEVICES
+        && (_connected.load() & (uint64_t(1) << deviceId)) != 0;
+}
+
+
+int SyntheticFrameSource::addDevice(const std::string& identity)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    for (std::size_t i = 0; i < _identities.size(); ++i)
+    {
+        if (!identity.empty() && _identities[i] == identity)
+        {
+            if (isPresent(i))
+            {
+                ofLogWarning("SyntheticFrameSource::addDevice") << "Device " << identity << " is already present.";
+            }
+
+            _present.fetch_or(uint64_t(1) << i);
+            return i;
+        }
+    }
+
+    if (_identities.size() >= MAX_DEVICES)
+    {
+        ofLogError("SyntheticFrameSource::addDevice") << "There are already " << MAX_DEVICES << " devices.";
+        return -1;
+    }
+
+    int deviceId = _identities.size();
+    _identities.push_back(identity.empty() ? name() + ":" + std::to_string(deviceId) : identity);
+    _present.fetch_or(uint64_t(1) << deviceId);
+    return deviceId;
+}
+
+
+bool SyntheticFrameSource::removeDevice(int deviceId)
+{
+    if (!isPresent(deviceId))
+    {
+        ofLogWarning("SyntheticFrameSource::removeDevice") << "No device with id " << deviceId << ".";
+        return false;
+    }
+
+    // Like unplugging, the device stops at once but stays connected until
+    // it is disconnected.
+    _present.fetch_and(~(uint64_t(1) << deviceId));
+    return true;
+}
+
+
+bool SyntheticFrameSource::pushFrame(int deviceId,
+                                     const MTTouch* touches,
+                                     int32_t numTouches,
+                                     double timestamp,
+                                     int32_t frameNum)
+{
+    if (!isConnected(deviceId) || !isPresent(deviceId))
+    {
+        return false;
+    }
+
+    notifyFrame(deviceId, touches, numTouches, timestamp, frameNum);
+    return true;
+}
+
+
+MTTouch SyntheticFrameSource::makeTouch(int32_t pathIndex,
+                                        MTTouchPhase phase,
+                                        float x,
+                                        float y)
+{
+    MTTouch touch;
+    std::memset(&touch, 0, sizeof(MTTouch));
+
+    touch.pathIndex = pathIndex;
+    touch.fingerID = pathIndex;
+    touch.handID = 1;
+    touch.phase = phase;
+    touch.normalizedVector.position.x = x;
+    touch.normalizedVector.position.y = y;
+    touch.zTotal = 0.5f;
+    touch.majorAxis = 10;
+    touch.minorAxis = 10;
+
+    return touch;
+}
+
+
+} // namespace ofx
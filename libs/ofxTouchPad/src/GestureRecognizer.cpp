@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/GestureRecognizer.h"
+#include <cmath>
+#include "ofVectorMath.h"
+#include "ofx/TouchPad.h"
+
+
+namespace ofx {
+
+
+GestureRecognizer::GestureRecognizer()
+{
+}
+
+
+void GestureRecognizer::process(int deviceId,
+                                const TouchBuffer& touches,
+                                double timestamp,
+                                const GestureSettings& settings,
+                                GestureEvents& events)
+{
+    // First pass: find the centroid and whether the set of touches changed.
+    bool changed = false;
+    bool cancelled = false;
+    std::size_t numTouches = 0;
+    glm::vec2 sum(0, 0);
+
+    for (const auto& touch: touches)
+    {
+        if (TouchPad::touchDeviceId(touch.id) != deviceId)
+        {
+            continue;
+        }
+
+        if (touch.type == ofTouchEventArgs::down
+         || touch.type == ofTouchEventArgs::up
+         || touch.type == ofTouchEventArgs::cancel)
+        {
+            changed = true;
+        }
+
+        if (touch.type == ofTouchEventArgs::cancel)
+        {
+            cancelled = true;
+        }
+
+        if (touch.type == ofTouchEventArgs::down || touch.type == ofTouchEventArgs::move)
+        {
+            sum += touch;
+            ++numTouches;
+        }
+    }
+
+    // Touches may have been lost to queue overflow.
+    changed = changed || numTouches != _args.numTouches;
+
+    if (changed && _isTracking)
+    {
+        end(settings, events, numTouches == 0 && !cancelled);
+    }
+
+    if (numTouches == 0)
+    {
+        _isTracking = false;
+        return;
+    }
+
+    glm::vec2 centroid = sum / float(numTouches);
+
+    // Second pass: find the spread and the mean rotation of each touch
+    // around the centroid since the previous frame.
+    bool continuing = _isTracking;
+    float spread = 0;
+    float rotationSum = 0;
+    std::size_t numRotations = 0;
+
+    for (const auto& touch: touches)
+    {
+        if (TouchPad::touchDeviceId(touch.id) != deviceId
+         || (touch.type != ofTouchEventArgs::down && touch.type != ofTouchEventArgs::move))
+        {
+            continue;
+        }
+
+        glm::vec2 offset = touch - centroid;
+        spread += glm::length(offset);
+
+        float angle = std::atan2(offset.y, offset.x);
+        TouchAngle& entry = _angles[touch.id & (ANGLE_TABLE_SIZE - 1)];
+
+        if (continuing && entry.id == touch.id)
+        {
+            float delta = angle - entry.angle;
+
+            if (delta > glm::pi<float>())
+            {
+                delta -= glm::two_pi<float>();
+            }
+            else if (delta < -glm::pi<float>())
+            {
+                delta += glm::two_pi<float>();
+            }
+
+            rotationSum += delta;
+            ++numRotations;
+        }
+
+        entry.id = touch.id;
+        entry.angle = angle;
+    }
+
+    spread /= numTouches;
+
+    _args.deviceId = deviceId;
+
+    if (!continuing)
+    {
+        begin(centroid, spread, numTouches, timestamp);
+        return;
+    }
+
+    double elapsed = timestamp - _args.timestamp;
+
+    _args.delta = centroid - _args.centroid;
+    _args.centroid = centroid;
+    _args.translation = centroid - _startCentroid;
+    _args.timestamp = timestamp;
+
+    if (elapsed > 0)
+    {
+        _args.velocity = glm::mix(_args.velocity,
+                                  _args.delta / float(elapsed),
+                                  settings.velocitySmoothing);
+    }
+
+    if (numTouches > 1)
+    {
+        if (_startSpread > 0)
+        {
+            _args.scale = spread / _startSpread;
+        }
+
+        if (numRotations > 0)
+        {
+            _args.rotation += rotationSum / numRotations;
+        }
+
+        if (_isPinching)
+        {
+            notify(events.pinch, GestureEventArgs::PINCH, GestureEventArgs::CHANGED);
+        }
+        else if (std::abs(_args.scale - 1) >= settings.pinchThreshold)
+        {
+            _isPinching = true;
+            notify(events.pinch, GestureEventArgs::PINCH, GestureEventArgs::BEGAN);
+        }
+
+        if (_isRotating)
+        {
+            notify(events.rotate, GestureEventArgs::ROTATE, GestureEventArgs::CHANGED);
+        }
+        else if (std::abs(_args.rotation) >= settings.rotateThreshold)
+        {
+            _isRotating = true;
+            notify(events.rotate, GestureEventArgs::ROTATE, GestureEventArgs::BEGAN);
+        }
+    }
+
+    if (_isPanning)
+    {
+        notify(events.pan, GestureEventArgs::PAN, GestureEventArgs::CHANGED);
+    }
+    else if (glm::length(_args.translation) >= settings.panThreshold)
+    {
+        _isPanning = true;
+        notify(events.pan, GestureEventArgs::PAN, GestureEventArgs::BEGAN);
+    }
+}
+
+
+void GestureRecognizer::reset()
+{
+    _isTracking = false;
+    _isPanning = false;
+    _isPinching = false;
+    _isRotating = false;
+    _args = GestureEventArgs();
+
+    for (auto& entry: _angles)
+    {
+        entry = TouchAngle();
+    }
+}
+
+
+void GestureRecognizer::begin(const glm::vec2& centroid,
+                              float spread,
+                              std::size_t numTouches,
+                              double timestamp)
+{
+    _isTracking = true;
+    _startCentroid = centroid;
+    _startSpread = spread;
+
+    _args.numTouches = numTouches;
+    _args.timestamp = timestamp;
+    _args.centroid = centroid;
+    _args.translation = glm::vec2(0, 0);
+    _args.delta = glm::vec2(0, 0);
+    _args.velocity = glm::vec2(0, 0);
+    _args.scale = 1;
+    _args.rotation = 0;
+}
+
+
+void GestureRecognizer::end(const GestureSettings& settings, GestureEvents& events, bool isLifted)
+{
+    if (_isPanning)
+    {
+        notify(events.pan, GestureEventArgs::PAN, GestureEventArgs::ENDED);
+    }
+
+    if (_isPinching)
+    {
+        notify(events.pinch, GestureEventArgs::PINCH, GestureEventArgs::ENDED);
+    }
+
+    if (_isRotating)
+    {
+        notify(events.rotate, GestureEventArgs::ROTATE, GestureEventArgs::ENDED);
+    }
+
+    if (isLifted && glm::length(_args.velocity) >= settings.swipeVelocity)
+    {
+        notify(events.swipe, GestureEventArgs::SWIPE, GestureEventArgs::ENDED);
+    }
+
+    _isTracking = false;
+    _isPanning = false;
+    _isPinching = false;
+    _isRotating = false;
+}
+
+
+void GestureRecognizer::notify(ofEvent<GestureEventArgs>& event,
+                               GestureEventArgs::Type type,
+                               GestureEventArgs::Phase phase)
+{
+    // Listeners get a copy so they can't disturb the running state.
+    GestureEventArgs args = _args;
+    args.type = type;
+    args.phase = phase;
+    ofNotifyEvent(event, args);
+}
+
+
+} // namespace ofx
@@ -0,0 +1,374 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/InputThread.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "ofLog.h"
+
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <pthread/qos.h>
+#endif
+
+
+namespace ofx {
+
+
+InputThread::InputThread():
+    _writePosition(0),
+    _isPushing(false),
+    _readPosition(0),
+    _isRunning(false),
+    _isWaiting(false),
+    _flushCount(0),
+    _pushedFrameCount(0),
+    _processedFrameCount(0),
+    _droppedFrameCount(0)
+{
+}
+
+
+InputThread::~InputThread()
+{
+    stop();
+}
+
+
+bool InputThread::start(const InputThreadSettings& settings, FrameCallback callback)
+{
+    if (_thread.joinable())
+    {
+        ofLogWarning("InputThread::start") << "The input thread is already running.";
+        return false;
+    }
+
+    _settings = settings;
+    _callback = callback;
+
+    // Always leave room for a frame with a few hundred touches.
+    _buffer.assign(std::max<std::size_t>(settings.bufferSize, sizeof(FrameHeader) + 256 * sizeof(MTTouch)), 0);
+    _touches.resize(256);
+
+    _writePosition = 0;
+    _readPosition = 0;
+    _pushedFrameCount = 0;
+    _processedFrameCount = 0;
+    _droppedFrameCount = 0;
+    _isRunning = true;
+
+    _thread = std::thread(&InputThread::run, this);
+
+    return true;
+}
+
+
+void InputThread::stop()
+{
+    if (!_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _isRunning = false;
+        _frameCondition.notify_one();
+        _idleCondition.notify_all();
+    }
+
+    _thread.join();
+}
+
+
+bool InputThread::isRunning() const
+{
+    return _isRunning.load();
+}
+
+
+bool InputThread::isInputThread() const
+{
+    return std::this_thread::get_id() == _thread.get_id();
+}
+
+
+InputThreadSettings InputThread::settings() const
+{
+    return _settings;
+}
+
+
+bool InputThread::push(int deviceId,
+                       const MTTouch* touches,
+                       int32_t numTouches,
+                       double timestamp,
+                       int32_t frameNum)
+{
+    numTouches = std::max(numTouches, 0);
+
+    // Frames from several devices may arrive on different threads.
+    while (_isPushing.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    std::size_t size = sizeof(FrameHeader) + numTouches * sizeof(MTTouch);
+    std::size_t writePosition = _writePosition.load(std::memory_order_relaxed);
+    std::size_t readPosition = _readPosition.load(std::memory_order_acquire);
+
+    if (_buffer.size() - (writePosition - readPosition) < size)
+    {
+        _isPushing.store(false, std::memory_order_release);
+        _droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    FrameHeader header;
+    header.deviceId = deviceId;
+    header.numTouches = numTouches;
+    header.timestamp = timestamp;
+    header.frameNum = frameNum;
+    header.reserved = 0;
+    header.receivedTime = std::chrono::steady_clock::now();
+
+    write(&header, sizeof(header), writePosition);
+    write(touches, numTouches * sizeof(MTTouch), writePosition + sizeof(header));
+
+    _pushedFrameCount.fetch_add(1);
+
+    // Sequentially consistent, so that either this sees the thread waiting
+    // or the thread sees the frame before it waits.
+    _writePosition.store(writePosition + size);
+
+    _isPushing.store(false, std::memory_order_release);
+
+    if (_isWaiting.load())
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _frameCondition.notify_one();
+    }
+
+    return true;
+}
+
+
+void InputThread::flush()
+{
+    if (!isRunning() || isInputThread())
+    {
+        return;
+    }
+
+    uint64_t target = _pushedFrameCount.load();
+
+    ++_flushCount;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        _idleCondition.wait(lock, [&]()
+        {
+            return _processedFrameCount.load() >= target || !_isRunning;
+        });
+    }
+
+    --_flushCount;
+}
+
+
+std::size_t InputThread::size() const
+{
+    uint64_t pushed = _pushedFrameCount.load(std::memory_order_relaxed);
+    uint64_t processed = _processedFrameCount.load(std::memory_order_relaxed);
+    return pushed > processed ? pushed - processed : 0;
+}
+
+
+uint64_t InputThread::processedFrameCount() const
+{
+    return _processedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+uint64_t InputThread::droppedFrameCount() const
+{
+    return _droppedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+void InputThread::applySettings()
+{
+#if defined(__linux__)
+    pthread_setname_np(pthread_self(), "ofxTouchPad");
+
+    if (_settings.priority > 0)
+    {
+        sched_param param;
+        param.sched_priority = std::min(std::max(_settings.priority, sched_get_priority_min(SCHED_FIFO)),
+                                        sched_get_priority_max(SCHED_FIFO));
+
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+
+        if (result != 0)
+        {
+            ofLogWarning("InputThread::applySettings") << "Unable to set real-time priority " << param.sched_priority << ": " << std::strerror(result);
+        }
+    }
+
+    if (_settings.cpu >= 0)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(_settings.cpu, &cpus);
+
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+
+        if (result != 0)
+        {
+            ofLogWarning("InputThread::applySettings") << "Unable to pin the input thread to CPU " << _settings.cpu << ": " << std::strerror(result);
+        }
+    }
+#elif defined(__APPLE__)
+    pthread_setname_np("ofxTouchPad");
+
+    if (_settings.priority > 0 && pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) != 0)
+    {
+        ofLogWarning("InputThread::applySettings") << "Unable to raise the input thread priority.";
+    }
+
+    if (_settings.cpu >= 0)
+    {
+        ofLogWarning("InputThread::applySettings") << "CPU affinity is only supported on Linux.";
+    }
+#else
+    if (_settings.priority > 0 || _settings.cpu >= 0)
+    {
+        ofLogWarning("InputThread::applySettings") << "Thread priority and affinity are not supported on this platform.";
+    }
+#endif
+}
+
+
+void InputThread::run()
+{
+    applySettings();
+
+    while (true)
+    {
+        if (processFrame())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        _isWaiting = true;
+        _idleCondition.notify_all();
+
+        _frameCondition.wait(lock, [this]()
+        {
+            return !isEmpty() || !_isRunning;
+        });
+
+        _isWaiting = false;
+
+        if (!_isRunning && isEmpty())
+        {
+            break;
+        }
+    }
+}
+
+
+bool InputThread::processFrame()
+{
+    std::size_t readPosition = _readPosition.load(std::memory_order_relaxed);
+
+    if (readPosition == _writePosition.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    FrameHeader header;
+    read(&header, sizeof(header), readPosition);
+
+    if (_touches.size() < static_cast<std::size_t>(header.numTouches))
+    {
+        _touches.resize(header.numTouches);
+    }
+
+    read(_touches.data(), header.numTouches * sizeof(MTTouch), readPosition + sizeof(header));
+
+    // Free the space before calling back, so the producer can reuse it.
+    _readPosition.store(readPosition + sizeof(header) + header.numTouches * sizeof(MTTouch),
+                        std::memory_order_release);
+
+    _callback(header.deviceId,
+              _touches.data(),
+              header.numTouches,
+              header.timestamp,
+              header.frameNum,
+              header.receivedTime);
+
+    _processedFrameCount.fetch_add(1);
+
+    if (_flushCount.load() > 0)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _idleCondition.notify_all();
+    }
+
+    return true;
+}
+
+
+bool InputThread::isEmpty() const
+{
+    return _readPosition.load(std::memory_order_relaxed) == _writePosition.load();
+}
+
+
+void InputThread::write(const void* data, std::size_t size, std::size_t position)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    // Positions increase monotonically and wrap around the ring.
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    std::size_t offset = position % _buffer.size();
+    std::size_t first = std::min(size, _buffer.size() - offset);
+
+    std::memcpy(_buffer.data() + offset, bytes, first);
+    std::memcpy(_buffer.data(), bytes + first, size - first);
+}
+
+
+void InputThread::read(void* data, std::size_t size, std::size_t position) const
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    uint8_t* bytes = static_cast<uint8_t*>(data);
+    std::size_t offset = position % _buffer.size();
+    std::size_t first = std::min(size, _buffer.size() - offset);
+
+    std::memcpy(bytes, _buffer.data() + offset, first);
+    std::memcpy(bytes + first, _buffer.data(), size - first);
+}
+
+
+} // namespace ofx
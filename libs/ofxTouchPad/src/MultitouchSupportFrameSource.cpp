@@ -0,0 +1,510 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/MultitouchSupportFrameSource.h"
+
+
+#if defined(__APPLE__)
+
+
+#include <algorithm>
+#include "ofLog.h"
+
+
+namespace ofx {
+
+
+MultitouchSupportFrameSource* MultitouchSupportFrameSource::_instance = nullptr;
+
+
+MultitouchSupportFrameSource::MultitouchSupportFrameSource()
+{
+    if (_instance != nullptr)
+    {
+        ofLogError("MultitouchSupportFrameSource::MultitouchSupportFrameSource") << "Only one instance may exist at a time.";
+    }
+
+    _instance = this;
+}
+
+
+MultitouchSupportFrameSource::~MultitouchSupportFrameSource()
+{
+    while (!_devices.empty())
+    {
+        disconnect(_devices.begin()->first);
+    }
+
+    if (_instance == this)
+    {
+        _instance = nullptr;
+    }
+
+    for (auto device: _retiredDevices)
+    {
+        delete device;
+    }
+
+    for (auto& device: _deviceList)
+    {
+        CFRelease(device.ref);
+    }
+}
+
+
+std::string MultitouchSupportFrameSource::name() const
+{
+    return "MultitouchSupport";
+}
+
+
+void MultitouchSupportFrameSource::refreshDeviceList()
+{
+    CFMutableArrayRef list = MTDeviceCreateList();
+
+    if (list == nullptr)
+    {
+        ofLogError("MultitouchSupportFrameSource::refreshDeviceList") << "MTDeviceCreateList returned NULL.";
+        return;
+    }
+
+    CFIndex count = CFArrayGetCount(list);
+
+    ofLogVerbose("MultitouchSupportFrameSource::refreshDeviceList") << "MTDeviceCreateList returned " << count << " devices.";
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::vector<bool> found(_deviceList.size(), false);
+
+    for (CFIndex i = 0; i < count; ++i)
+    {
+        MTDeviceRef ref = (MTDeviceRef)CFArrayGetValueAtIndex(list, i);
+        std::string deviceIdentity = identity(ref);
+
+        auto iter = std::find_if(_deviceList.begin(), _deviceList.end(), [&](const Device& device)
+        {
+            return deviceIdentity.empty() ? device.ref == ref : device.identity == deviceIdentity;
+        });
+
+        if (iter == _deviceList.end())
+        {
+            // Describing a device takes a dozen driver calls, so skip it
+            // unless the output is wanted.
+            if (ofGetLogLevel("MultitouchSupportFrameSource::printDeviceInfo") <= OF_LOG_VERBOSE)
+            {
+                printDeviceInfo(ref);
+            }
+
+            Device device;
+            device.ref = ref;
+            device.identity = deviceIdentity;
+            device.name = MTDeviceIsBuiltIn && MTDeviceIsBuiltIn(ref) ? "Built-in Trackpad" : "Multitouch Device";
+            device.isPresent = true;
+            CFRetain(ref);
+
+            _deviceList.push_back(device);
+            found.push_back(true);
+        }
+        else
+        {
+            std::size_t deviceId = iter - _deviceList.begin();
+
+            // A device that was plugged back in has a new reference. Frames
+            // no longer arrive on the old one, so a connection to it is
+            // dropped and the device manager connects the new one.
+            if (iter->ref != ref)
+            {
+                auto connected = _devices.find(deviceId);
+
+                if (connected != _devices.end())
+                {
+                    ofLogVerbose("MultitouchSupportFrameSource::refreshDeviceList") << "Device " << deviceId << " was plugged back in.";
+                    stopDevice(connected);
+                }
+
+                CFRetain(ref);
+                CFRelease(iter->ref);
+                iter->ref = ref;
+            }
+
+            iter->isPresent = true;
+            found[deviceId] = true;
+        }
+    }
+
+    for (std::size_t i = 0; i < _deviceList.size(); ++i)
+    {
+        _deviceList[i].isPresent = found[i];
+    }
+
+    CFRelease(list);
+}
+
+
+std::size_t MultitouchSupportFrameSource::numDevices() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _deviceList.size();
+}
+
+
+bool MultitouchSupportFrameSource::isPresent(int deviceId) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_deviceList.size()) && _deviceList[deviceId].isPresent;
+}
+
+
+std::string MultitouchSupportFrameSource::deviceIdentity(int deviceId) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (deviceId < 0 || deviceId >= static_cast<int>(_deviceList.size()))
+    {
+        return "";
+    }
+
+    // Fall back to the index for devices without a GUID or device ID.
+    const Device& device = _deviceList[deviceId];
+    return device.identity.empty() ? name() + ":" + std::to_string(deviceId) : device.identity;
+}
+
+
+std::string MultitouchSupportFrameSource::deviceName(int deviceId) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return deviceId >= 0 && deviceId < static_cast<int>(_deviceList.size()) ? _deviceList[deviceId].name : "";
+}
+
+
+bool MultitouchSupportFrameSource::connect(int deviceId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (deviceId >= 0 && deviceId < static_cast<int>(_deviceList.size()) && _deviceList[deviceId].isPresent)
+    {
+        if (_devices.find(deviceId) == _devices.end())
+        {
+            // get the device reference
+            MTDeviceRef mtDeviceRef = _deviceList[deviceId].ref;
+
+            int32_t width  = -1;
+            int32_t height = -1;
+            
+            OSStatus err = MTDeviceGetSensorSurfaceDimensions(mtDeviceRef, &width, &height);
+
+            ofRectangle rect;
+
+            if (!err)
+			{
+                rect.set(0, 0, width / 100.0f, height / 100.0f);
+            }
+			else
+			{
+                ofLogError("MultitouchSupportFrameSource::connect") << "Unable to get device dimensions.";
+            }
+
+            deleteRetiredDevices();
+
+            // store a reference w/ a device number before frames can arrive
+            DeviceInfo* info = new DeviceInfo(mtDeviceRef, deviceId, rect);
+            _devices[deviceId] = info;
+            setDevice(mtDeviceRef, info);
+
+            // register the callback for the reference
+            MTRegisterContactFrameCallback(mtDeviceRef, mt_callback);
+            // start the device
+            MTDeviceStart(mtDeviceRef);
+
+            return true;
+        }
+        else
+        {
+            ofLogWarning("MultitouchSupportFrameSource::connect") << "Already connected to device " << deviceId << ".";
+            return false;
+        }
+    }
+    else
+    {
+        ofLogWarning("MultitouchSupportFrameSource::connect") << "No multitouch device with id " << deviceId << ".";
+        return false;
+    }
+}
+
+
+bool MultitouchSupportFrameSource::disconnect(int deviceId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto iter = _devices.find(deviceId);
+
+    if (iter != _devices.end())
+    {
+        stopDevice(iter);
+        return true;
+    }
+    else
+    {
+        ofLogWarning("MultitouchSupportFrameSource::disconnect") << "Not connected to device " << deviceId << ".";
+        return false;
+    }
+}
+
+
+bool MultitouchSupportFrameSource::isConnected(int deviceId) const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _devices.find(deviceId) != _devices.end();
+}
+
+
+bool MultitouchSupportFrameSource::hasSteadyTimestamps() const
+{
+    return true;
+}
+
+
+void MultitouchSupportFrameSource::mt_callback(MTDeviceRef deviceRef,
+                                               MTTouch* touches,
+                                               int32_t numTouches,
+                                               double timestamp,
+                                               int32_t frameNum)
+{
+    MultitouchSupportFrameSource* source = _instance;
+
+    if (source == nullptr)
+    {
+        return;
+    }
+
+    // Retired devices aren't deleted while a callback is running.
+    source->_activeCallbacks.fetch_add(1);
+
+    DeviceInfo* device = source->findDevice(deviceRef);
+
+    if (device != nullptr)
+    {
+        source->notifyFrame(device->id, touches, numTouches, timestamp, frameNum);
+    }
+
+    source->_activeCallbacks.fetch_sub(1);
+}
+
+
+DeviceInfo* MultitouchSupportFrameSource::findDevice(MTDeviceRef deviceRef) const
+{
+    std::size_t index = hash(deviceRef);
+
+    for (std::size_t i = 0; i < DEVICE_TABLE_SIZE; ++i)
+    {
+        const DeviceTableEntry& entry = _deviceTable[(index + i) & (DEVICE_TABLE_SIZE - 1)];
+        MTDeviceRef ref = entry.ref.load(std::memory_order_acquire);
+
+        if (ref == deviceRef)
+        {
+            DeviceInfo* info = entry.info.load(std::memory_order_acquire);
+
+            // A cleared entry may be reused for another device meanwhile.
+            return info != nullptr && info->ref == deviceRef ? info : nullptr;
+        }
+        else if (ref == nullptr)
+        {
+            break;
+        }
+    }
+
+    return nullptr;
+}
+
+
+void MultitouchSupportFrameSource::setDevice(MTDeviceRef deviceRef, DeviceInfo* info)
+{
+    std::size_t index = hash(deviceRef);
+
+    DeviceTableEntry* freeEntry = nullptr;
+
+    for (std::size_t i = 0; i < DEVICE_TABLE_SIZE; ++i)
+    {
+        DeviceTableEntry& entry = _deviceTable[(index + i) & (DEVICE_TABLE_SIZE - 1)];
+        MTDeviceRef ref = entry.ref.load(std::memory_order_relaxed);
+
+        if (ref == deviceRef)
+        {
+            entry.info.store(info, std::memory_order_release);
+            return;
+        }
+        else if (ref == nullptr)
+        {
+            if (freeEntry == nullptr)
+            {
+                freeEntry = &entry;
+            }
+
+            break;
+        }
+        else if (freeEntry == nullptr && entry.info.load(std::memory_order_relaxed) == nullptr)
+        {
+            // Remember the first cleared entry, but keep looking in case the
+            // reference is further along.
+            freeEntry = &entry;
+        }
+    }
+
+    if (info == nullptr)
+    {
+        return;
+    }
+    else if (freeEntry == nullptr)
+    {
+        ofLogError("MultitouchSupportFrameSource::setDevice") << "The device table is full.";
+        return;
+    }
+
+    // Publish the info before the key, so readers never see a key without
+    // its info.
+    freeEntry->info.store(info, std::memory_order_release);
+    freeEntry->ref.store(deviceRef, std::memory_order_release);
+}
+
+
+void MultitouchSupportFrameSource::deleteRetiredDevices()
+{
+    // The retired devices are no longer in the table, so only a callback
+    // that found one before it was cleared can be using it.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (_activeCallbacks.load() != 0)
+    {
+        return;
+    }
+
+    for (auto device: _retiredDevices)
+    {
+        delete device;
+    }
+
+    _retiredDevices.clear();
+}
+
+
+void MultitouchSupportFrameSource::stopDevice(DeviceMap::iterator iter)
+{
+    MTDeviceStop(iter->second->ref);
+    MTUnregisterContactFrameCallback(iter->second->ref, mt_callback);
+    setDevice(iter->second->ref, nullptr);
+    _retiredDevices.push_back(iter->second); // deallocate later
+    _devices.erase(iter); // remove it from the list
+    deleteRetiredDevices();
+}
+
+
+std::size_t MultitouchSupportFrameSource::hash(MTDeviceRef deviceRef)
+{
+    // Device refs are heap pointers, so drop the alignment bits.
+    return reinterpret_cast<std::uintptr_t>(deviceRef) >> 4;
+}
+
+
+std::string MultitouchSupportFrameSource::identity(MTDeviceRef deviceRef)
+{
+    uuid_t guid;
+
+    if (!MTDeviceGetGUID(deviceRef, &guid))
+    {
+        uuid_string_t val;
+        uuid_unparse(guid, val);
+        return val;
+    }
+
+    uint64_t devID;
+
+    if (MTDeviceGetDeviceID && !MTDeviceGetDeviceID(deviceRef, &devID))
+    {
+        return std::to_string(devID);
+    }
+
+    return "";
+}
+
+
+void MultitouchSupportFrameSource::printDeviceInfo(MTDeviceRef deviceRef)
+{
+    ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "-------------------";
+
+    uuid_t guid;
+
+    if (!MTDeviceGetGUID(deviceRef, &guid))
+    {
+        uuid_string_t val;
+        uuid_unparse(guid, val);
+        ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "GUID: " << val;
+    }
+
+    bool supportsActuation = MTDeviceSupportsActuation(deviceRef);
+    bool supportsForce = MTDeviceSupportsForce(deviceRef);
+
+    ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Supports Actuation: " << supportsActuation;
+    ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Supports Force: " << supportsForce;
+
+    int a;
+
+    if (!MTDeviceGetDriverType(deviceRef, &a))
+    {
+        ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Driver type: " << a;
+
+        int _a;
+//        if (!MTDeviceGetActualType(deviceRef, &_a))
+//        {
+//            ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Actual Driver type: " << _a;
+//        }
+    }
+    
+    if (MTDeviceGetDeviceID)
+    {
+        uint64_t devID;
+        
+        if (!MTDeviceGetDeviceID(deviceRef, &devID))
+        {
+            ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Device ID: " << devID;
+        }
+    }
+
+    if (!MTDeviceGetFamilyID(deviceRef, &a))
+    {
+        ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Family ID: " << a;
+    }
+    
+    int b;
+
+    if (!MTDeviceGetSensorSurfaceDimensions(deviceRef, &a, &b))
+    {
+        ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Dimensions: " << a / 100.0f << " x " << b / 100.0;
+    }
+
+    if (!MTDeviceGetSensorDimensions(deviceRef, &a, &b))
+    {
+        ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Rows: " << a << " Columns: " << b;
+    }
+
+    if (MTDeviceIsBuiltIn)
+    {
+        if (MTDeviceIsBuiltIn(deviceRef))
+        {
+            ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Is device built-in: YES";
+        }
+        else
+        {
+            ofLogVerbose("MultitouchSupportFrameSource::printDeviceInfo") << "Is device built-in: NO";
+        }
+    }
+}
+
+
+} // namespace ofx
+
+
+#endif // __APPLE__
@@ -0,0 +1,536 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/ReplayFrameSource.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "ofLog.h"
+#include "ofUtils.h"
+
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+namespace ofx {
+
+
+ReplayFrameSource::ReplayFrameSource():
+    _connectedDevices(0)
+{
+}
+
+
+ReplayFrameSource::ReplayFrameSource(const std::string& path):
+    ReplayFrameSource()
+{
+    load(path);
+}
+
+
+ReplayFrameSource::~ReplayFrameSource()
+{
+    unload();
+}
+
+
+bool ReplayFrameSource::load(const std::string& path)
+{
+    unload();
+
+    std::string absolutePath = ofToDataPath(path, true);
+
+#if !defined(_WIN32)
+
+    int fd = ::open(absolutePath.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        ofLogError("ReplayFrameSource::load") << "Unable to open " << path << ".";
+        return false;
+    }
+
+    struct stat info;
+
+    if (::fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        ofLogError("ReplayFrameSource::load") << "Unable to read " << path << ".";
+        ::close(fd);
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        ofLogError("ReplayFrameSource::load") << "Unable to map " << path << ".";
+        return false;
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+    _size = info.st_size;
+
+#else
+
+    std::ifstream stream(absolutePath, std::ios::binary);
+
+    if (!stream)
+    {
+        ofLogError("ReplayFrameSource::load") << "Unable to open " << path << ".";
+        return false;
+    }
+
+    _fallbackData.assign(std::istreambuf_iterator<char>(stream),
+                         std::istreambuf_iterator<char>());
+    _data = _fallbackData.data();
+    _size = _fallbackData.size();
+
+#endif
+
+    if (!buildIndex())
+    {
+        ofLogError("ReplayFrameSource::load") << path << " is not a valid recording.";
+        unload();
+        return false;
+    }
+
+    ofLogVerbose("ReplayFrameSource::load") << "Loaded " << _index.size() << " frames from " << _numDevices << " devices.";
+
+    return true;
+}
+
+
+void ReplayFrameSource::unload()
+{
+    pause();
+
+#if !defined(_WIN32)
+    if (_data != nullptr)
+    {
+        ::munmap(const_cast<uint8_t*>(_data), _size);
+    }
+#endif
+
+    _fallbackData.clear();
+    _data = nullptr;
+    _size = 0;
+    _index.clear();
+    _numDevices = 0;
+    _position = 0;
+    _connectedDevices = 0;
+}
+
+
+bool ReplayFrameSource::isLoaded() const
+{
+    return _data != nullptr;
+}
+
+
+std::string ReplayFrameSource::name() const
+{
+    return "Replay";
+}
+
+
+void ReplayFrameSource::refreshDeviceList()
+{
+}
+
+
+std::size_t ReplayFrameSource::numDevices() const
+{
+    return _numDevices;
+}
+
+
+bool ReplayFrameSource::connect(int deviceId)
+{
+    if (deviceId >= 0 && deviceId < static_cast<int>(_numDevices))
+    {
+        uint64_t bit = uint64_t(1) << deviceId;
+
+        if ((_connectedDevices.fetch_or(bit) & bit) == 0)
+        {
+            return true;
+        }
+        else
+        {
+            ofLogWarning("ReplayFrameSource::connect") << "Already connected to device " << deviceId << ".";
+            return false;
+        }
+    }
+    else
+    {
+        ofLogWarning("ReplayFrameSource::connect") << "No device with id " << deviceId << " in the recording.";
+        return false;
+    }
+}
+
+
+bool ReplayFrameSource::disconnect(int deviceId)
+{
+    if (isConnected(deviceId))
+    {
+        _connectedDevices.fetch_and(~(uint64_t(1) << deviceId));
+        return true;
+    }
+    else
+    {
+        ofLogWarning("ReplayFrameSource::disconnect") << "Not connected to device " << deviceId << ".";
+        return false;
+    }
+}
+
+
+bool ReplayFrameSource::isConnected(int deviceId) const
+{
+    return deviceId >= 0
+        && deviceId < MAX_DEVICES
+        && (_connectedDevices.load(std::memory_order_relaxed) & (uint64_t(1) << deviceId)) != 0;
+}
+
+
+void ReplayFrameSource::play()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_isPlaying || _index.empty())
+    {
+        return;
+    }
+
+    if (_thread.joinable())
+    {
+        // A thread that stopped at the end of the recording.
+        lock.unlock();
+        _thread.join();
+        lock.lock();
+    }
+
+    _isPlaying = true;
+    resetClock();
+    _thread = std::thread(&ReplayFrameSource::playbackThread, this);
+}
+
+
+void ReplayFrameSource::pause()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _isPlaying = false;
+    }
+
+    _condition.notify_all();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+
+void ReplayFrameSource::stop()
+{
+    pause();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _position = 0;
+}
+
+
+bool ReplayFrameSource::isPlaying() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _isPlaying;
+}
+
+
+bool ReplayFrameSource::step()
+{
+    std::size_t position = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_position >= _index.size())
+        {
+            return false;
+        }
+
+        position = _position++;
+    }
+
+    deliver(position);
+    return true;
+}
+
+
+void ReplayFrameSource::seek(double time)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        if (_index.empty())
+        {
+            return;
+        }
+
+        double timestamp = _index.front().timestamp + time;
+
+        auto iter = std::lower_bound(_index.begin(),
+                                     _index.end(),
+                                     timestamp,
+                                     [](const IndexEntry& entry, double value)
+                                     {
+                                         return entry.timestamp < value;
+                                     });
+
+        _position = iter - _index.begin();
+        resetClock();
+    }
+
+    _condition.notify_all();
+}
+
+
+double ReplayFrameSource::position() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_index.empty())
+    {
+        return 0;
+    }
+
+    std::size_t position = std::min(_position, _index.size() - 1);
+    return _index[position].timestamp - _index.front().timestamp;
+}
+
+
+double ReplayFrameSource::duration() const
+{
+    if (_index.empty())
+    {
+        return 0;
+    }
+
+    return _index.back().timestamp - _index.front().timestamp;
+}
+
+
+std::size_t ReplayFrameSource::frameCount() const
+{
+    return _index.size();
+}
+
+
+ReplayFrameSource::PlaybackMode ReplayFrameSource::getPlaybackMode() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _playbackMode;
+}
+
+
+void ReplayFrameSource::setPlaybackMode(PlaybackMode mode)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _playbackMode = mode;
+        resetClock();
+    }
+
+    _condition.notify_all();
+}
+
+
+double ReplayFrameSource::getRate() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _rate;
+}
+
+
+void ReplayFrameSource::setRate(double rate)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _rate = std::max(rate, 0.0001);
+        resetClock();
+    }
+
+    _condition.notify_all();
+}
+
+
+bool ReplayFrameSource::isLooping() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _isLooping;
+}
+
+
+void ReplayFrameSource::setLooping(bool looping)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _isLooping = looping;
+}
+
+
+bool ReplayFrameSource::buildIndex()
+{
+    if (_size < sizeof(TouchRecording::FileHeader))
+    {
+        return false;
+    }
+
+    TouchRecording::FileHeader header;
+    std::memcpy(&header, _data, sizeof(header));
+
+    if (std::memcmp(header.magic, TouchRecording::magic(), sizeof(header.magic)) != 0
+     || header.version != TouchRecording::VERSION
+     || header.byteOrderMark != TouchRecording::BYTE_ORDER_MARK
+     || header.headerSize > _size)
+    {
+        return false;
+    }
+
+    // The frames are delivered in place, so the layout must match this build.
+    std::vector<TouchRecording::FieldInfo> fields = TouchRecording::touchFields();
+
+    if (header.touchSize != sizeof(MTTouch)
+     || header.numFields != fields.size()
+     || header.headerSize != sizeof(header) + fields.size() * sizeof(TouchRecording::FieldInfo)
+     || std::memcmp(_data + sizeof(header), fields.data(), fields.size() * sizeof(TouchRecording::FieldInfo)) != 0)
+    {
+        ofLogError("ReplayFrameSource::buildIndex") << "The recorded MTTouch layout does not match this build.";
+        return false;
+    }
+
+    std::size_t offset = header.headerSize;
+
+    while (offset + sizeof(TouchRecording::FrameHeader) <= _size)
+    {
+        TouchRecording::FrameHeader frame;
+        std::memcpy(&frame, _data + offset, sizeof(frame));
+
+        std::size_t frameSize = TouchRecording::frameSize(frame.numTouches);
+
+        if (frame.numTouches < 0 || offset + frameSize > _size)
+        {
+            ofLogWarning("ReplayFrameSource::buildIndex") << "Ignoring a truncated frame at the end of the recording.";
+            break;
+        }
+
+        if (frame.deviceId < 0 || frame.deviceId >= MAX_DEVICES)
+        {
+            ofLogWarning("ReplayFrameSource::buildIndex") << "Ignoring a frame from device " << frame.deviceId << ".";
+        }
+        else
+        {
+            _index.push_back({ frame.timestamp, offset });
+            _numDevices = std::max<std::size_t>(_numDevices, frame.deviceId + 1);
+        }
+
+        offset += frameSize;
+    }
+
+    // Frames from several devices may be slightly out of order.
+    std::stable_sort(_index.begin(),
+                     _index.end(),
+                     [](const IndexEntry& a, const IndexEntry& b)
+                     {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    return true;
+}
+
+
+void ReplayFrameSource::resetClock()
+{
+    _clockStart = Clock::now();
+    _clockTimestamp = _position < _index.size() ? _index[_position].timestamp : 0;
+    _clockReset = true;
+}
+
+
+void ReplayFrameSource::deliver(std::size_t position) const
+{
+    const uint8_t* data = _data + _index[position].offset;
+
+    TouchRecording::FrameHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (isConnected(header.deviceId))
+    {
+        // Every record is 8 byte aligned, so the touches are used in place.
+        const MTTouch* touches = reinterpret_cast<const MTTouch*>(data + sizeof(header));
+        notifyFrame(header.deviceId, touches, header.numTouches, header.timestamp, header.frameNum);
+    }
+}
+
+
+void ReplayFrameSource::playbackThread()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (_isPlaying)
+    {
+        if (_position >= _index.size())
+        {
+            if (_isLooping)
+            {
+                _position = 0;
+                resetClock();
+            }
+            else
+            {
+                _isPlaying = false;
+                break;
+            }
+        }
+
+        _clockReset = false;
+
+        if (_playbackMode != PLAYBACK_AS_FAST_AS_POSSIBLE)
+        {
+            double delay = (_index[_position].timestamp - _clockTimestamp) / effectiveRate();
+
+            Clock::time_point due = _clockStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(delay));
+
+            // Wake early if paused, seeked or the rate changed.
+            if (_condition.wait_until(lock, due, [this]() { return !_isPlaying || _clockReset; }))
+            {
+                continue;
+            }
+        }
+
+        std::size_t position = _position++;
+
+        lock.unlock();
+        deliver(position);
+        lock.lock();
+    }
+}
+
+
+double ReplayFrameSource::effectiveRate() const
+{
+    return _playbackMode == PLAYBACK_SCALED ? _rate : 1;
+}
+
+
+} // namespace ofx
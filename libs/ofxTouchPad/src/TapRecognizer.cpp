@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TapRecognizer.h"
+#include <algorithm>
+#include "ofVectorMath.h"
+#include "ofx/TouchPad.h"
+
+
+namespace ofx {
+
+
+TapRecognizer::TapRecognizer()
+{
+}
+
+
+void TapRecognizer::process(int deviceId,
+                            const TouchBuffer& touches,
+                            double timestamp,
+                            const TapSettings& settings,
+                            TapEvents& events)
+{
+    for (const auto& touch: touches)
+    {
+        if (TouchPad::touchDeviceId(touch.id) != deviceId)
+        {
+            continue;
+        }
+
+        if (touch.type == ofTouchEventArgs::down)
+        {
+            if (_numTouches == 0)
+            {
+                _isCandidate = true;
+                _isLongPressed = false;
+                _sequenceStart = timestamp;
+                _sequenceTouches = 0;
+                _sequenceStartSum = glm::vec2(0, 0);
+                _sequenceDowns = 0;
+                _sequenceFirstId = touch.id;
+            }
+            else if (timestamp - _sequenceStart > settings.tapDuration)
+            {
+                // A finger that joins late makes a new gesture, not a tap.
+                _isCandidate = false;
+            }
+
+            if (find(touch.id) == nullptr && _numTouches < TouchBuffer::CAPACITY)
+            {
+                TouchState& state = _touches[_numTouches++];
+                state.id = touch.id;
+                state.start = touch;
+
+                _sequenceTouches = std::max(_sequenceTouches, _numTouches);
+                _sequenceStartSum += touch;
+                ++_sequenceDowns;
+            }
+        }
+        else if (touch.type == ofTouchEventArgs::cancel)
+        {
+            TouchState* state = find(touch.id);
+
+            if (state != nullptr)
+            {
+                // A cancelled touch never taps.
+                _isCandidate = false;
+                remove(state);
+
+                if (_numTouches == 0)
+                {
+                    finishSequence(deviceId, touch.id, timestamp, settings, events);
+                }
+            }
+        }
+        else if (touch.type == ofTouchEventArgs::move || touch.type == ofTouchEventArgs::up)
+        {
+            TouchState* state = find(touch.id);
+
+            if (state == nullptr)
+            {
+                // The down was never seen, e.g. it was lost to queue overflow.
+                continue;
+            }
+
+            if (glm::distance(glm::vec2(touch), state->start) > settings.tapRadius)
+            {
+                _isCandidate = false;
+            }
+
+            if (touch.type == ofTouchEventArgs::up)
+            {
+                remove(state);
+
+                if (_numTouches == 0)
+                {
+                    finishSequence(deviceId, touch.id, timestamp, settings, events);
+                }
+            }
+        }
+    }
+
+    if (_numTouches > 0
+     && _isCandidate
+     && !_isLongPressed
+     && timestamp - _sequenceStart >= settings.longPressDuration)
+    {
+        _isLongPressed = true;
+
+        TapEventArgs args;
+        args.deviceId = deviceId;
+        args.touchId = _sequenceFirstId;
+        args.numTouches = _sequenceTouches;
+        args.tapCount = 1;
+        args.position = _sequenceStartSum / float(_sequenceDowns);
+        args.timestamp = timestamp;
+        ofNotifyEvent(events.longPress, args);
+    }
+}
+
+
+void TapRecognizer::reset()
+{
+    _numTouches = 0;
+    _isCandidate = false;
+    _isLongPressed = false;
+    _tapCount = 0;
+}
+
+
+TapRecognizer::TouchState* TapRecognizer::find(int touchId)
+{
+    for (std::size_t i = 0; i < _numTouches; ++i)
+    {
+        if (_touches[i].id == touchId)
+        {
+            return &_touches[i];
+        }
+    }
+
+    return nullptr;
+}
+
+
+void TapRecognizer::remove(TouchState* state)
+{
+    *state = _touches[--_numTouches];
+}
+
+
+void TapRecognizer::finishSequence(int deviceId,
+                                   int touchId,
+                                   double timestamp,
+                                   const TapSettings& settings,
+                                   TapEvents& events)
+{
+    if (!_isCandidate
+     || _isLongPressed
+     || _sequenceTouches == 0
+     || timestamp - _sequenceStart > settings.tapDuration)
+    {
+        _tapCount = 0;
+        return;
+    }
+
+    glm::vec2 position = _sequenceStartSum / float(_sequenceDowns);
+
+    if (_tapCount > 0
+     && _sequenceTouches == _lastTapTouches
+     && _sequenceStart - _lastTapTime <= settings.multiTapInterval
+     && glm::distance(position, _lastTapPosition) <= settings.multiTapRadius)
+    {
+        ++_tapCount;
+    }
+    else
+    {
+        _tapCount = 1;
+    }
+
+    _lastTapTouches = _sequenceTouches;
+    _lastTapTime = timestamp;
+    _lastTapPosition = position;
+
+    TapEventArgs args;
+    args.deviceId = deviceId;
+    args.touchId = touchId;
+    args.numTouches = _sequenceTouches;
+    args.tapCount = _tapCount;
+    args.position = position;
+    args.timestamp = timestamp;
+    ofNotifyEvent(events.tap, args);
+}
+
+
+} // namespace ofx
@@ -0,0 +1,188 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchFilter.h"
+#include <cmath>
+#include "ofMath.h"
+
+
+namespace ofx {
+
+
+static_assert(TouchFrame::CAPACITY <= 256, "Pool indices are stored as uint8_t.");
+
+
+void TouchFilter::AxisState::reset(float position, const FilterSettings& settings)
+{
+    value = position;
+    derivative = 0;
+    variance = settings.measurementNoise;
+}
+
+
+float TouchFilter::AxisState::update(float position, float dt, const FilterSettings& settings)
+{
+    switch (settings.filter)
+    {
+        case FilterSettings::FILTER_ONE_EURO:
+        {
+            // Casiez, Roussel and Vogel, "1€ Filter", CHI 2012.
+            auto alpha = [dt](float cutoff)
+            {
+                return 1.0f / (1.0f + 1.0f / (glm::two_pi<float>() * cutoff * dt));
+            };
+
+            float speed = (position - value) / dt;
+            derivative += alpha(settings.derivativeCutoff) * (speed - derivative);
+
+            float cutoff = settings.minCutoff + settings.beta * std::abs(derivative);
+            value += alpha(cutoff) * (position - value);
+            break;
+        }
+        case FilterSettings::FILTER_KALMAN:
+        {
+            variance += settings.processNoise * dt;
+            float gain = variance / (variance + settings.measurementNoise);
+            value += gain * (position - value);
+            variance *= 1 - gain;
+            break;
+        }
+        case FilterSettings::FILTER_EMA:
+        {
+            value += settings.smoothing * (position - value);
+            break;
+        }
+        default:
+            value = position;
+    }
+
+    return value;
+}
+
+
+TouchFilter::TouchFilter()
+{
+    reset();
+}
+
+
+void TouchFilter::apply(TouchFrame& frame, double timestamp, const FilterSettings& settings)
+{
+    if (settings.filter != _filter)
+    {
+        // State from another filter is meaningless.
+        reset();
+        _filter = settings.filter;
+    }
+
+    if (_filter == FilterSettings::FILTER_NONE)
+    {
+        return;
+    }
+
+    ++_frameCount;
+
+    for (std::size_t i = 0; i < frame.size(); ++i)
+    {
+        ActiveTouch* touch = find(frame.pathIndex[i], i);
+        bool isNew = touch == nullptr || frame.phase[i] == MTTouchStateMakeTouch;
+
+        if (touch == nullptr)
+        {
+            if (_numFree == 0)
+            {
+                // The pool is exhausted; leave the touch unfiltered.
+                continue;
+            }
+
+            touch = &_active[_numActive++];
+            touch->pathIndex = frame.pathIndex[i];
+            touch->state = _free[--_numFree];
+        }
+
+        FilterState& state = _pool[touch->state];
+
+        if (isNew)
+        {
+            state.x.reset(frame.x[i], settings);
+            state.y.reset(frame.y[i], settings);
+            state.timestamp = timestamp;
+        }
+        else
+        {
+            float dt = static_cast<float>(timestamp - state.timestamp);
+
+            // Repeated timestamps carry no new information.
+            if (dt > 0)
+            {
+                state.x.update(frame.x[i], dt, settings);
+                state.y.update(frame.y[i], dt, settings);
+                state.timestamp = timestamp;
+            }
+
+            frame.x[i] = state.x.value;
+            frame.y[i] = state.y.value;
+        }
+
+        // A touch that left is released below with the missing touches.
+        touch->frameCount = frame.phase[i] == MTTouchStateOutOfRange ? 0 : _frameCount;
+    }
+
+    for (std::size_t i = 0; i < _numActive;)
+    {
+        if (_active[i].frameCount != _frameCount)
+        {
+            release(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+void TouchFilter::reset()
+{
+    _numActive = 0;
+    _numFree = POOL_SIZE;
+
+    for (std::size_t i = 0; i < POOL_SIZE; ++i)
+    {
+        _free[i] = static_cast<uint8_t>(POOL_SIZE - 1 - i);
+    }
+}
+
+
+TouchFilter::ActiveTouch* TouchFilter::find(int32_t pathIndex, std::size_t hint)
+{
+    // The driver usually lists touches in the same order every frame.
+    if (hint < _numActive && _active[hint].pathIndex == pathIndex)
+    {
+        return &_active[hint];
+    }
+
+    for (std::size_t i = 0; i < _numActive; ++i)
+    {
+        if (_active[i].pathIndex == pathIndex)
+        {
+            return &_active[i];
+        }
+    }
+
+    return nullptr;
+}
+
+
+void TouchFilter::release(std::size_t activeIndex)
+{
+    _free[_numFree++] = _active[activeIndex].state;
+    _active[activeIndex] = _active[--_numActive];
+}
+
+
+} // namespace ofx
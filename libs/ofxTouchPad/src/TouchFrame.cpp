@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchFrame.h"
+#include <algorithm>
+#include <cstring>
+#include "ofMath.h"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define OFX_TOUCHPAD_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define OFX_TOUCHPAD_NEON
+    #include <arm_neon.h>
+#endif
+
+
+namespace ofx {
+
+
+static_assert(TouchFrame::CAPACITY % 4 == 0, "The capacity must be a multiple of the vector width.");
+static_assert(int(TouchFrame::CAPACITY) <= int(TouchBuffer::CAPACITY), "A converted frame must fit in a TouchBuffer.");
+
+
+TouchFrame::TouchFrame()
+{
+    // Zero the padding lanes once so the kernel never reads garbage.
+    std::memset(x, 0, sizeof(x));
+    std::memset(y, 0, sizeof(y));
+    std::memset(vx, 0, sizeof(vx));
+    std::memset(vy, 0, sizeof(vy));
+    std::memset(ax, 0, sizeof(ax));
+    std::memset(ay, 0, sizeof(ay));
+    std::memset(predictedX, 0, sizeof(predictedX));
+    std::memset(predictedY, 0, sizeof(predictedY));
+    std::memset(majorAxis, 0, sizeof(majorAxis));
+    std::memset(minorAxis, 0, sizeof(minorAxis));
+    std::memset(angle, 0, sizeof(angle));
+    std::memset(pressure, 0, sizeof(pressure));
+    std::memset(pathIndex, 0, sizeof(pathIndex));
+    std::fill(phase, phase + CAPACITY, MTTouchStateNotTracking);
+}
+
+
+void TouchFrame::clear()
+{
+    _size = 0;
+}
+
+
+void TouchFrame::assign(const MTTouch* touches, int32_t numTouches, bool absolute)
+{
+    _size = std::min<std::size_t>(std::max<int32_t>(numTouches, 0), CAPACITY);
+
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        const MTTouch& touch = touches[i];
+        const MTVector& vector = absolute ? touch.absoluteVector : touch.normalizedVector;
+
+        x[i] = vector.position.x;
+        y[i] = vector.position.y;
+        vx[i] = vector.velocity.x;
+        vy[i] = vector.velocity.y;
+        ax[i] = 0;
+        ay[i] = 0;
+        majorAxis[i] = touch.majorAxis;
+        minorAxis[i] = touch.minorAxis;
+        angle[i] = touch.angle;
+        pressure[i] = touch.zTotal;
+        pathIndex[i] = touch.pathIndex;
+        phase[i] = touch.phase;
+    }
+}
+
+
+void TouchFrame::extendBounds(float& minX, float& minY, float& maxX, float& maxY) const
+{
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        minX = std::min(x[i], minX);
+        minY = std::min(y[i], minY);
+        maxX = std::max(x[i], maxX);
+        maxY = std::max(y[i], maxY);
+    }
+}
+
+
+void TouchFrame::transform(const TouchFrameTransform& t)
+{
+    // Round up to whole vectors; the padding lanes are ignored.
+    const std::size_t n = (_size + 3) & ~std::size_t(3);
+
+    const float twoPi = glm::two_pi<float>();
+    const float invRangeX = t.maxX > t.minX ? 1.0f / (t.maxX - t.minX) : 0.0f;
+    const float invRangeY = t.maxY > t.minY ? 1.0f / (t.maxY - t.minY) : 0.0f;
+
+#if defined(OFX_TOUCHPAD_SSE2)
+
+    const __m128 vTwoPi = _mm_set1_ps(twoPi);
+
+    if (t.normalize)
+    {
+        const __m128 vZero = _mm_setzero_ps();
+        const __m128 vOne = _mm_set1_ps(1.0f);
+        const __m128 vMinX = _mm_set1_ps(t.minX);
+        const __m128 vMinY = _mm_set1_ps(t.minY);
+        const __m128 vInvRangeX = _mm_set1_ps(invRangeX);
+        const __m128 vInvRangeY = _mm_set1_ps(invRangeY);
+        const __m128 vScaleX = _mm_set1_ps(t.scaleX);
+        const __m128 vScaleY = _mm_set1_ps(t.scaleY);
+        const __m128 vOffsetX = _mm_set1_ps(t.offsetX);
+        const __m128 vOffsetY = _mm_set1_ps(t.offsetY);
+
+        for (std::size_t i = 0; i < n; i += 4)
+        {
+            __m128 px = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(x + i), vMinX), vInvRangeX);
+            __m128 py = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(y + i), vMinY), vInvRangeY);
+            px = _mm_min_ps(_mm_max_ps(px, vZero), vOne);
+            py = _mm_sub_ps(vOne, _mm_min_ps(_mm_max_ps(py, vZero), vOne));
+            _mm_store_ps(x + i, _mm_add_ps(_mm_mul_ps(px, vScaleX), vOffsetX));
+            _mm_store_ps(y + i, _mm_add_ps(_mm_mul_ps(py, vScaleY), vOffsetY));
+
+            _mm_store_ps(vx + i, _mm_mul_ps(_mm_load_ps(vx + i), vScaleX));
+            _mm_store_ps(vy + i, _mm_mul_ps(_mm_sub_ps(vZero, _mm_load_ps(vy + i)), vScaleY));
+        }
+    }
+
+    for (std::size_t i = 0; i < n; i += 4)
+    {
+        _mm_store_ps(angle + i, _mm_sub_ps(vTwoPi, _mm_load_ps(angle + i)));
+    }
+
+#elif defined(OFX_TOUCHPAD_NEON)
+
+    const float32x4_t vTwoPi = vdupq_n_f32(twoPi);
+
+    if (t.normalize)
+    {
+        const float32x4_t vZero = vdupq_n_f32(0.0f);
+        const float32x4_t vOne = vdupq_n_f32(1.0f);
+        const float32x4_t vMinX = vdupq_n_f32(t.minX);
+        const float32x4_t vMinY = vdupq_n_f32(t.minY);
+        const float32x4_t vInvRangeX = vdupq_n_f32(invRangeX);
+        const float32x4_t vInvRangeY = vdupq_n_f32(invRangeY);
+        const float32x4_t vScaleX = vdupq_n_f32(t.scaleX);
+        const float32x4_t vScaleY = vdupq_n_f32(t.scaleY);
+        const float32x4_t vOffsetX = vdupq_n_f32(t.offsetX);
+        const float32x4_t vOffsetY = vdupq_n_f32(t.offsetY);
+
+        for (std::size_t i = 0; i < n; i += 4)
+        {
+            float32x4_t px = vmulq_f32(vsubq_f32(vld1q_f32(x + i), vMinX), vInvRangeX);
+            float32x4_t py = vmulq_f32(vsubq_f32(vld1q_f32(y + i), vMinY), vInvRangeY);
+            px = vminq_f32(vmaxq_f32(px, vZero), vOne);
+            py = vsubq_f32(vOne, vminq_f32(vmaxq_f32(py, vZero), vOne));
+            vst1q_f32(x + i, vmlaq_f32(vOffsetX, px, vScaleX));
+            vst1q_f32(y + i, vmlaq_f32(vOffsetY, py, vScaleY));
+
+            vst1q_f32(vx + i, vmulq_f32(vld1q_f32(vx + i), vScaleX));
+            vst1q_f32(vy + i, vmulq_f32(vnegq_f32(vld1q_f32(vy + i)), vScaleY));
+        }
+    }
+
+    for (std::size_t i = 0; i < n; i += 4)
+    {
+        vst1q_f32(angle + i, vsubq_f32(vTwoPi, vld1q_f32(angle + i)));
+    }
+
+#else
+
+    if (t.normalize)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            float px = std::min(std::max((x[i] - t.minX) * invRangeX, 0.0f), 1.0f);
+            float py = 1.0f - std::min(std::max((y[i] - t.minY) * invRangeY, 0.0f), 1.0f);
+            x[i] = px * t.scaleX + t.offsetX;
+            y[i] = py * t.scaleY + t.offsetY;
+            vx[i] = vx[i] * t.scaleX;
+            vy[i] = -vy[i] * t.scaleY;
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        angle[i] = twoPi - angle[i];
+    }
+
+#endif
+}
+
+
+std::size_t TouchFrame::size() const
+{
+    return _size;
+}
+
+
+const char* TouchFrame::kernelName()
+{
+#if defined(OFX_TOUCHPAD_SSE2)
+    return "SSE2";
+#elif defined(OFX_TOUCHPAD_NEON)
+    return "NEON";
+#else
+    return "Scalar";
+#endif
+}
+
+
+} // namespace ofx
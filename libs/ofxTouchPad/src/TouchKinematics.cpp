@@ -0,0 +1,277 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchKinematics.h"
+#include <algorithm>
+#include <cmath>
+
+
+namespace ofx {
+
+
+void TouchKinematics::TouchState::start(float px, float py, double pt)
+{
+    head = 0;
+    count = 1;
+    x[0] = px;
+    y[0] = py;
+    t[0] = pt;
+    fx = px;
+    fy = py;
+    vx = 0;
+    vy = 0;
+    ax = 0;
+    ay = 0;
+}
+
+
+void TouchKinematics::TouchState::push(float px, float py, double pt)
+{
+    head = (head + 1) % HISTORY_SIZE;
+    count = std::min<std::size_t>(count + 1, HISTORY_SIZE);
+    x[head] = px;
+    y[head] = py;
+    t[head] = pt;
+}
+
+
+TouchKinematics::TouchKinematics()
+{
+}
+
+
+void TouchKinematics::update(TouchFrame& frame, double timestamp, const KinematicsSettings& settings)
+{
+    if (settings.estimator == KinematicsSettings::ESTIMATOR_DRIVER)
+    {
+        _numTouches = 0;
+        std::fill(frame.ax, frame.ax + frame.size(), 0.0f);
+        std::fill(frame.ay, frame.ay + frame.size(), 0.0f);
+        return;
+    }
+
+    ++_frameCount;
+
+    for (std::size_t i = 0; i < frame.size(); ++i)
+    {
+        // The driver usually lists touches in the same order every frame.
+        TouchState* state = i < _numTouches && _touches[i].pathIndex == frame.pathIndex[i]
+                          ? &_touches[i]
+                          : find(frame.pathIndex[i]);
+
+        if (state == nullptr)
+        {
+            if (_numTouches == TouchFrame::CAPACITY)
+            {
+                frame.vx[i] = frame.vy[i] = frame.ax[i] = frame.ay[i] = 0;
+                continue;
+            }
+
+            state = &_touches[_numTouches++];
+            state->pathIndex = frame.pathIndex[i];
+            state->start(frame.x[i], frame.y[i], timestamp);
+        }
+        else if (frame.phase[i] == MTTouchStateMakeTouch)
+        {
+            // The path index has been reused for a new contact.
+            state->start(frame.x[i], frame.y[i], timestamp);
+        }
+        else
+        {
+            float dt = static_cast<float>(timestamp - state->t[state->head]);
+
+            // Repeated timestamps carry no new information.
+            if (dt > 0)
+            {
+                state->push(frame.x[i], frame.y[i], timestamp);
+
+                switch (settings.estimator)
+                {
+                    case KinematicsSettings::ESTIMATOR_LEAST_SQUARES:
+                        estimateLeastSquares(*state, settings.window);
+                        break;
+                    case KinematicsSettings::ESTIMATOR_ALPHA_BETA:
+                        estimateAlphaBeta(*state, frame.x[i], frame.y[i], dt, settings);
+                        break;
+                    default:
+                        estimateFiniteDifference(*state, frame.x[i], frame.y[i], dt);
+                        break;
+                }
+            }
+        }
+
+        state->frameCount = _frameCount;
+
+        frame.vx[i] = state->vx;
+        frame.vy[i] = state->vy;
+        frame.ax[i] = state->ax;
+        frame.ay[i] = state->ay;
+    }
+
+    // Forget touches that were not in this frame.
+    for (std::size_t i = 0; i < _numTouches;)
+    {
+        if (_touches[i].frameCount != _frameCount)
+        {
+            _touches[i] = _touches[--_numTouches];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+void TouchKinematics::predict(TouchFrame& frame, float horizon)
+{
+    const float halfHorizon2 = 0.5f * horizon * horizon;
+
+    for (std::size_t i = 0; i < frame.size(); ++i)
+    {
+        frame.predictedX[i] = frame.x[i] + frame.vx[i] * horizon + frame.ax[i] * halfHorizon2;
+        frame.predictedY[i] = frame.y[i] + frame.vy[i] * horizon + frame.ay[i] * halfHorizon2;
+    }
+}
+
+
+void TouchKinematics::reset()
+{
+    _numTouches = 0;
+}
+
+
+TouchKinematics::TouchState* TouchKinematics::find(int32_t pathIndex)
+{
+    for (std::size_t i = 0; i < _numTouches; ++i)
+    {
+        if (_touches[i].pathIndex == pathIndex)
+        {
+            return &_touches[i];
+        }
+    }
+
+    return nullptr;
+}
+
+
+void TouchKinematics::estimateFiniteDifference(TouchState& state, float px, float py, float dt)
+{
+    std::size_t previous = (state.head + HISTORY_SIZE - 1) % HISTORY_SIZE;
+
+    float vx = (px - state.x[previous]) / dt;
+    float vy = (py - state.y[previous]) / dt;
+
+    // The first difference has no previous velocity.
+    if (state.count > 2)
+    {
+        state.ax = (vx - state.vx) / dt;
+        state.ay = (vy - state.vy) / dt;
+    }
+
+    state.vx = vx;
+    state.vy = vy;
+}
+
+
+void TouchKinematics::estimateLeastSquares(TouchState& state, std::size_t window)
+{
+    std::size_t n = std::min(state.count, std::min<std::size_t>(std::max<std::size_t>(window, 3), HISTORY_SIZE));
+
+    if (n < 3)
+    {
+        std::size_t previous = (state.head + HISTORY_SIZE - 1) % HISTORY_SIZE;
+        float dt = static_cast<float>(state.t[state.head] - state.t[previous]);
+        estimateFiniteDifference(state, state.x[state.head], state.y[state.head], dt);
+        return;
+    }
+
+    // Fit p(τ) = c0 + c1 τ + c2 τ² with τ and p relative to the latest
+    // sample, so the velocity is c1 and the acceleration is 2 c2.
+    double s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+    double bx0 = 0, bx1 = 0, bx2 = 0;
+    double by0 = 0, by1 = 0, by2 = 0;
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        std::size_t j = (state.head + HISTORY_SIZE - k) % HISTORY_SIZE;
+
+        double tau = state.t[j] - state.t[state.head];
+        double tau2 = tau * tau;
+        double dx = state.x[j] - state.x[state.head];
+        double dy = state.y[j] - state.y[state.head];
+
+        s1 += tau;
+        s2 += tau2;
+        s3 += tau2 * tau;
+        s4 += tau2 * tau2;
+        bx0 += dx;
+        bx1 += dx * tau;
+        bx2 += dx * tau2;
+        by0 += dy;
+        by1 += dy * tau;
+        by2 += dy * tau2;
+    }
+
+    double s0 = static_cast<double>(n);
+
+    // Cramer's rule on the normal equations.
+    double det = s0 * (s2 * s4 - s3 * s3)
+               - s1 * (s1 * s4 - s3 * s2)
+               + s2 * (s1 * s3 - s2 * s2);
+
+    if (std::abs(det) < 1e-30)
+    {
+        return;
+    }
+
+    double invDet = 1.0 / det;
+
+    state.vx = static_cast<float>((s0 * (bx1 * s4 - s3 * bx2)
+                                 - bx0 * (s1 * s4 - s3 * s2)
+                                 + s2 * (s1 * bx2 - bx1 * s2)) * invDet);
+
+    state.vy = static_cast<float>((s0 * (by1 * s4 - s3 * by2)
+                                 - by0 * (s1 * s4 - s3 * s2)
+                                 + s2 * (s1 * by2 - by1 * s2)) * invDet);
+
+    state.ax = static_cast<float>(2 * (s0 * (s2 * bx2 - bx1 * s3)
+                                     - s1 * (s1 * bx2 - bx1 * s2)
+                                     + bx0 * (s1 * s3 - s2 * s2)) * invDet);
+
+    state.ay = static_cast<float>(2 * (s0 * (s2 * by2 - by1 * s3)
+                                     - s1 * (s1 * by2 - by1 * s2)
+                                     + by0 * (s1 * s3 - s2 * s2)) * invDet);
+}
+
+
+void TouchKinematics::estimateAlphaBeta(TouchState& state,
+                                        float px,
+                                        float py,
+                                        float dt,
+                                        const KinematicsSettings& settings)
+{
+    // Predict.
+    float predictedX = state.fx + (state.vx + 0.5f * state.ax * dt) * dt;
+    float predictedY = state.fy + (state.vy + 0.5f * state.ay * dt) * dt;
+    float predictedVx = state.vx + state.ax * dt;
+    float predictedVy = state.vy + state.ay * dt;
+
+    // Correct with the residual.
+    float rx = px - predictedX;
+    float ry = py - predictedY;
+
+    state.fx = predictedX + settings.alpha * rx;
+    state.fy = predictedY + settings.alpha * ry;
+    state.vx = predictedVx + settings.beta * rx / dt;
+    state.vy = predictedVy + settings.beta * ry / dt;
+    state.ax += 2 * settings.gamma * rx / (dt * dt);
+    state.ay += 2 * settings.gamma * ry / (dt * dt);
+}
+
+
+} // namespace ofx
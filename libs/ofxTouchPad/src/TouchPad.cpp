@@ -6,327 +6,1153 @@
 
 
 #include "ofx/TouchPad.h"
+#include <thread>
 #include "ofMath.h" 
 #include "ofLog.h"
+#include "ofx/EvdevFrameSource.h"
+#include "ofx/MultitouchSupportFrameSource.h"
 
 
 namespace ofx {
 
 
-float TouchPad::_minNormalizedPositionX = 0;
-float TouchPad::_minNormalizedPositionY = 0;
-float TouchPad::_maxNormalizedPositionX = 1;
-float TouchPad::_maxNormalizedPositionY = 1;
+namespace {
 
 
-void TouchPad::refreshDeviceList()
+uint64_t toNanoseconds(std::chrono::steady_clock::duration duration)
 {
-    _deviceList = MTDeviceCreateList();
-    
-    if (_deviceList == nullptr)
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+
+/// \brief The TouchPad whose frame callback this thread is running, and how
+/// many times it is nested.
+thread_local const TouchPad* callbackTouchPad = nullptr;
+thread_local int callbackDepth = 0;
+
+
+uint64_t elapsedNanoseconds(std::chrono::steady_clock::time_point start)
+{
+    return toNanoseconds(std::chrono::steady_clock::now() - start);
+}
+
+
+} // namespace
+
+
+void TouchPad::processFrame(int deviceId,
+                            const MTTouch* touches,
+                            int32_t numTouches,
+                            double timestamp,
+                            int32_t frameNum,
+                            std::chrono::steady_clock::time_point receivedTime)
+{
+    TouchPad& pad = *this;
+
+    DeviceState* state = deviceState(deviceId);
+
+    if (state == nullptr)
     {
-        _nDevices = 0;
-        ofLogError("TouchPad::refreshDeviceList") << "MTDeviceCreateList returned NULL.";
+        return;
     }
-    else
+
+    auto callbackTime = std::chrono::steady_clock::now();
+
+    DeviceState& device = *state;
+    device.stats.framesReceived.fetch_add(1, std::memory_order_relaxed);
+
+    if (_inputThread.isInputThread())
+    {
+        device.stats.inputLatency.record(toNanoseconds(callbackTime - receivedTime));
+    }
+
+    if (_recorder.isRecording())
+    {
+        _recorder.record(deviceId, touches, numTouches, timestamp, frameNum);
+    }
+
+    if (_rawFrameEvent.size() > 0)
+    {
+        RawFrame rawFrame;
+        rawFrame.deviceId = deviceId;
+        rawFrame.touches = touches;
+        rawFrame.numTouches = numTouches;
+        rawFrame.timestamp = timestamp;
+        rawFrame.frameNum = frameNum;
+        ofNotifyEvent(_rawFrameEvent, rawFrame);
+    }
+
+    ContactFrame& frame = device.frame;
+    frame.deviceId = deviceId;
+    frame.timestamp = timestamp;
+    frame.frameNum = frameNum;
+    frame.receivedTime = receivedTime;
+
+    frame.touches.clear();
+    frame.hovers.clear();
+    frame.history.clear();
+
+    if (!isFrameConversionEnabled())
+    {
+        if (device.phases.size() > 0)
+        {
+            // End the touches that were down when conversion was disabled.
+            device.phases.cancelAll(frame);
+            device.filter.reset();
+            device.kinematics.reset();
+
+            if (getDispatchMode() != DISPATCH_IMMEDIATE)
+            {
+                _frameQueue.push(frame);
+            }
+            else
+            {
+                registerTouchEvents(frame);
+            }
+        }
+
+        device.stats.callbackTime.record(elapsedNanoseconds(callbackTime));
+        return;
+    }
+
+    PipelineSettings settings = _settings.load();
+    ScalingMode scalingMode = settings.scalingMode;
+    const KinematicsSettings& kinematicsSettings = settings.kinematics;
+
+    TouchFrame& touchFrame = device.touchFrame;
+    touchFrame.assign(touches, numTouches, scalingMode == ABSOLUTE);
+
+    device.stats.touchesConverted.fetch_add(touchFrame.size(), std::memory_order_relaxed);
+
+    if (numTouches > static_cast<int32_t>(touchFrame.size()))
+    {
+        device.stats.touchesDropped.fetch_add(numTouches - touchFrame.size(), std::memory_order_relaxed);
+    }
+
+    TouchFrameTransform transform;
+
+    switch (scalingMode)
+    {
+        case SCALE_TO_WINDOW:
+        {
+            transform.scaleX = ofGetWidth();
+            transform.scaleY = ofGetHeight();
+            break;
+        }
+        case SCALE_TO_RECT:
+        {
+            ofRectangle scalingRect(settings.scalingRect[0],
+                                    settings.scalingRect[1],
+                                    settings.scalingRect[2],
+                                    settings.scalingRect[3]);
+
+            if (scalingRect.isEmpty())
+            {
+                // The window may not have existed when the pad was created.
+                scalingRect.set(0, 0, ofGetWidth(), ofGetHeight());
+            }
+
+            transform.scaleX = scalingRect.width;
+            transform.scaleY = scalingRect.height;
+            transform.offsetX = scalingRect.x;
+            transform.offsetY = scalingRect.y;
+            break;
+        }
+        case NORMALIZED:
+        {
+            break;
+        }
+        case ABSOLUTE:
+        {
+            transform.normalize = false;
+            break;
+        }
+        default:
+            ofLogError("TouchPad::processFrame") << "Unknown scaling mode = " << scalingMode << ".";
+    }
+
+    if (transform.normalize)
+    {
+        // This is a hack to fix non-normalized position data from the multi-touch framework.
+        device.calibration.extend(touchFrame);
+        device.calibration.apply(transform);
+    }
+
+    // Convert the whole frame at once.
+    touchFrame.transform(transform);
+
+    device.filter.apply(touchFrame, timestamp, _filterSettings.load());
+    device.kinematics.update(touchFrame, timestamp, kinematicsSettings);
+    TouchKinematics::predict(touchFrame, kinematicsSettings.predictionHorizon);
+
+    device.phases.beginFrame();
+
+    for (std::size_t i = 0; i < touchFrame.size(); ++i)
     {
-        _nDevices = CFArrayGetCount(_deviceList);
+        if (touchFrame.pathIndex[i] < 0)
+        {
+            ofLogError("TouchPad::processFrame") << "Callback produced an id < 0.";
+            continue;
+        }
+
+        ofTouchEventArgs touchEvt;
+        touchEvt.id         = touchId(deviceId, touchFrame.pathIndex[i]);
+        touchEvt.numTouches = numTouches;
+        touchEvt.x          = touchFrame.x[i];
+        touchEvt.y          = touchFrame.y[i];
+        touchEvt.xspeed     = touchFrame.vx[i];
+        touchEvt.yspeed     = touchFrame.vy[i];
+        touchEvt.xaccel     = touchFrame.ax[i];
+        touchEvt.yaccel     = touchFrame.ay[i];
+        touchEvt.minoraxis  = touchFrame.minorAxis[i];
+        touchEvt.majoraxis  = touchFrame.majorAxis[i];
+        touchEvt.angle      = touchFrame.angle[i];
+        touchEvt.pressure   = touchFrame.pressure[i];
+
+        device.phases.update(touchEvt,
+                             glm::vec2(touchFrame.predictedX[i], touchFrame.predictedY[i]),
+                             touchFrame.phase[i],
+                             frame);
     }
 
-    ofLogVerbose("TouchPad::refreshDeviceList") << "MTDeviceCreateList returned " << _nDevices << " devices.";
+    // End any touches that the driver stopped reporting.
+    device.phases.endFrame(frame);
 
-    for (CFIndex i = 0; i < _nDevices; ++i)
-        printDeviceInfo(CFArrayGetValueAtIndex(_deviceList, i));
+    if (!frame.touches.empty() || !frame.hovers.empty())
+    {
+        if (getDispatchMode() != DISPATCH_IMMEDIATE)
+        {
+            _frameQueue.push(frame);
+        }
+        else
+        {
+            pad.registerTouchEvents(frame);
+        }
+    }
+
+    device.stats.callbackTime.record(elapsedNanoseconds(callbackTime));
 }
 
 
-void TouchPad::mt_callback(MTDeviceRef deviceId,
-                           MTTouch* touches,
-                           int32_t numTouches,
-                           double timestamp,
-                           int32_t frameNum)
+void TouchPad::registerTouchEvents(const ContactFrame& frame)
 {
-    TouchPad& pad = TouchPad::instance();
-    
-    TouchPad::Touches touchEvents;
+    std::unique_lock<std::mutex> lock(_dispatchMutex);
+
+    PipelineSettings settings = _settings.load();
 
-    glm::vec2 windowSize(ofGetWidth(), ofGetHeight());
-    const auto& scalingRect = pad.getScalingRect();
+    auto dispatchTime = std::chrono::steady_clock::now();
 
-    for (std::size_t i = 0; i < numTouches; ++i)
+    DeviceStats* stats = nullptr;
+
+    if (DeviceState* device = deviceState(frame.deviceId))
     {
-        MTTouch* evt = &touches[i];
+        stats = &device->stats;
+        stats->deliveryLatency.record(toNanoseconds(dispatchTime - frame.receivedTime));
 
-        ofTouchEventArgs touchEvt;
+        if (_hasSteadyTimestamps.load(std::memory_order_relaxed))
+        {
+            double driverTime = std::chrono::duration<double>(dispatchTime.time_since_epoch()).count();
+            stats->driverLatency.record(static_cast<uint64_t>(std::max(0.0, driverTime - frame.timestamp) * 1e9));
+        }
+    }
 
-        touchEvt.id             = evt->pathIndex;
-        touchEvt.numTouches     = numTouches;
+    // A coalesced frame may hold touches from several devices.
+    ++_dispatchCount;
 
-        // This is a hack to fix non-normalized position data from the multi-touch framework.
-        _minNormalizedPositionX = std::min(evt->normalizedVector.position.x, _minNormalizedPositionX);
-        _minNormalizedPositionY = std::min(evt->normalizedVector.position.y, _minNormalizedPositionY);
-        _maxNormalizedPositionX = std::max(evt->normalizedVector.position.x, _maxNormalizedPositionX);
-        _maxNormalizedPositionY = std::max(evt->normalizedVector.position.y, _maxNormalizedPositionY);
-
-        glm::vec2 normPos;
-        glm::vec2 normVel;
-
-        normPos.x = ofMap(evt->normalizedVector.position.x,
-                          _minNormalizedPositionX,
-                          _maxNormalizedPositionX,
-                          0,
-                          1,
-                          true);
-
-        normPos.y = 1.0f - ofMap(evt->normalizedVector.position.y,
-                                 _minNormalizedPositionY,
-                                 _maxNormalizedPositionY,
-                                 0,
-                                 1,
-                                 true);
-
-        normVel.x = evt->normalizedVector.velocity.x;
-        normVel.y = 1.0f - evt->normalizedVector.velocity.y;
-
-        switch (pad.getScalingMode())
-        {
-            case SCALE_TO_WINDOW:
+    auto markDispatched = [this](int touchId)
+    {
+        DeviceState* device = deviceState(touchDeviceId(touchId));
+
+        if (device != nullptr)
+        {
+            device->dispatchCount = _dispatchCount;
+            device->stats.eventsDispatched.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return device;
+    };
+
+    for (std::size_t i = 0; i < frame.touches.size(); ++i)
+    {
+        const ofTouchEventArgs& touch = frame.touches[i];
+        DeviceState* device = markDispatched(touch.id);
+
+        if (device == nullptr)
+        {
+            continue;
+        }
+
+        if (touch.type == ofTouchEventArgs::down || touch.type == ofTouchEventArgs::move)
+        {
+            // Touches beyond the table capacity are dispatched but not tracked.
+            std::size_t slot = _activeTouches.insert(touch, frame.touches.predicted(i));
+
+            if (slot != ActiveTouchTable::NO_SLOT)
             {
-                touchEvt.x = normPos.x * windowSize.x;
-                touchEvt.y = normPos.y * windowSize.y;
-                touchEvt.xspeed = normVel.x * windowSize.x;
-                touchEvt.yspeed = normVel.y * windowSize.y;
-                break;
+                _activeTouchDispatchCounts[slot] = _dispatchCount;
             }
-            case SCALE_TO_RECT:
+            else
             {
-                touchEvt.x = normPos.x * scalingRect.width + scalingRect.x;
-                touchEvt.y = normPos.y * scalingRect.height + scalingRect.y;
-                touchEvt.xspeed = normVel.x * scalingRect.width;
-                touchEvt.yspeed = normVel.y * scalingRect.height;
-                break;
+                device->stats.untrackedEvents.fetch_add(1, std::memory_order_relaxed);
             }
-            case NORMALIZED:
+        }
+        else if (touch.type == ofTouchEventArgs::up || touch.type == ofTouchEventArgs::cancel)
+        {
+            _activeTouches.erase(touch.id);
+        }
+    }
+
+    for (const auto& hover: frame.hovers)
+    {
+        markDispatched(hover.id);
+    }
+
+    // The frame that is fired, which differs from the dispatched frame only
+    // if touches were lost.
+    const ContactFrame* events = &frame;
+
+    // Every frame lists all of a device's touches that are down, so any touch
+    // it left out ended in a frame that was lost to queue overflow.
+    for (std::size_t slot = 0; slot < ActiveTouchTable::CAPACITY; ++slot)
+    {
+        if (_activeTouches.occupied(slot) && _activeTouchDispatchCounts[slot] != _dispatchCount)
+        {
+            ofTouchEventArgs touch = _activeTouches[slot];
+            DeviceState* device = deviceState(touchDeviceId(touch.id));
+
+            if (device == nullptr || device->dispatchCount == _dispatchCount)
             {
-                touchEvt.x = normPos.x;
-                touchEvt.y = normPos.y;
-                touchEvt.xspeed = normVel.x;
-                touchEvt.yspeed = normVel.y;
-                break;
+                if (events == &frame)
+                {
+                    _eventFrame = frame;
+                    events = &_eventFrame;
+                }
+
+                touch.type = ofTouchEventArgs::cancel;
+
+                if (!_eventFrame.touches.push_back(touch, _activeTouches.predicted(slot)) && device != nullptr)
+                {
+                    device->stats.cancelsDropped.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                _activeTouches.erase(touch.id);
             }
-            case ABSOLUTE:
-            {
-                touchEvt.x = evt->absoluteVector.position.x;
-                touchEvt.y = evt->absoluteVector.position.y;
-                touchEvt.xspeed = evt->absoluteVector.velocity.x;
-                touchEvt.yspeed = evt->absoluteVector.velocity.y;
+        }
+    }
+
+    auto listenerTime = std::chrono::steady_clock::now();
+
+    _dispatchHistory = &events->history;
+
+    ofNotifyEvent(_frameEvent, *events);
+
+    // The per-touch events are only prepared for events with listeners.
+    for (std::size_t i = 0; settings.isCoreTouchEventsEnabled && i < events->touches.size(); ++i)
+    {
+        const auto& touch = events->touches[i];
+        ofEvent<ofTouchEventArgs>* event = nullptr;
+
+        switch (touch.type)
+        {
+            case ofTouchEventArgs::down:
+                event = &ofEvents().touchDown;
+                break;
+            case ofTouchEventArgs::move:
+                event = &ofEvents().touchMoved;
+                break;
+            case ofTouchEventArgs::up:
+                event = &ofEvents().touchUp;
+                break;
+            case ofTouchEventArgs::cancel:
+                event = &ofEvents().touchCancelled;
                 break;
-            }
             default:
-                ofLogError("TouchPad::mt_callback") << "Unknown scaling mode = " << pad.getScalingMode() << ".";
+                break;
         }
-                           
-        touchEvt.xaccel = 0;
-        touchEvt.yaccel = 0;
 
-        touchEvt.minoraxis = evt->minorAxis;
-        touchEvt.majoraxis = evt->majorAxis;
-        
-        touchEvt.angle = glm::two_pi<float>() - evt->angle;
-        touchEvt.pressure = evt->zTotal;
+        if (event != nullptr && event->size() > 0)
+        {
+            ofTouchEventArgs t = touch;
+            ofNotifyEvent(*event, t);
+        }
+    }
 
-        if (evt->phase == MTTouchStateMakeTouch)
+    if (_hoverEvent.size() > 0)
+    {
+        for (const auto& hover: events->hovers)
         {
-            touchEvt.type = ofTouchEventArgs::down;
+            ofTouchEventArgs t = hover;
+            ofNotifyEvent(_hoverEvent, t);
         }
-        else if (evt->phase == MTTouchStateTouching)
+    }
+
+    _dispatchHistory = nullptr;
+
+    if (stats != nullptr)
+    {
+        stats->listenerTime.record(elapsedNanoseconds(listenerTime));
+    }
+
+    std::size_t numDeviceStates = _numDeviceStates.load(std::memory_order_acquire);
+
+    for (std::size_t i = 0; i < numDeviceStates; ++i)
+    {
+        DeviceState& device = *_deviceStates[i];
+
+        if (device.dispatchCount == _dispatchCount)
         {
-            touchEvt.type = ofTouchEventArgs::move;
+            device.taps.process(i, events->touches, events->timestamp, settings.taps, _tapEvents);
+            device.gestures.process(i, events->touches, events->timestamp, settings.gestures, _gestureEvents);
         }
-        else if (evt->phase == MTTouchStateOutOfRange)
+    }
+
+    TouchSnapshot& snapshot = _snapshots.back();
+    snapshot.version = ++_snapshotVersion;
+    snapshot.timestamp = frame.timestamp;
+    snapshot.touches.clear();
+
+    for (std::size_t slot = 0; slot < ActiveTouchTable::CAPACITY; ++slot)
+    {
+        if (_activeTouches.occupied(slot))
         {
-            touchEvt.type = ofTouchEventArgs::up;
+            snapshot.slots[snapshot.touches.size()] = static_cast<uint8_t>(slot);
+            snapshot.touches.push_back(_activeTouches[slot], _activeTouches.predicted(slot));
         }
-        else
+    }
+
+    // The legacy accessors may be called from several threads, so they read
+    // their own copy.
+    _legacySnapshots.back() = snapshot;
+
+    _snapshots.publish();
+    _legacySnapshots.publish();
+
+    if (stats != nullptr)
+    {
+        stats->dispatchTime.record(elapsedNanoseconds(dispatchTime));
+    }
+}
+
+
+int TouchPad::touchId(int deviceId, int pathIndex)
+{
+    return (deviceId << TOUCH_ID_DEVICE_SHIFT) | (pathIndex & TOUCH_ID_PATH_MASK);
+}
+
+
+int TouchPad::touchDeviceId(int touchId)
+{
+    return touchId >> TOUCH_ID_DEVICE_SHIFT;
+}
+
+
+int TouchPad::touchPathIndex(int touchId)
+{
+    return touchId & TOUCH_ID_PATH_MASK;
+}
+
+
+TouchPad::TouchPad():
+    _exitListener(ofEvents().exit.newListener(this, &TouchPad::exit)),
+    _updateListener(ofEvents().update.newListener(this, &TouchPad::update, OF_EVENT_ORDER_BEFORE_APP)),
+    _tapListener(_tapEvents.tap.newListener(this, &TouchPad::onTap))
+{
+    PipelineSettings settings;
+    settings.taps.multiTapInterval = DEFAULT_DOUBLE_TAP_SPEED / 1000.0;
+    _settings.store(settings);
+
+    // A source without devices until setup() picks the backend.
+    setFrameSource(std::unique_ptr<FrameSource>(new SyntheticFrameSource(0)));
+}
+
+
+TouchPad::TouchPad(const TouchPadSettings& settings): TouchPad()
+{
+    setup(settings);
+}
+
+
+bool TouchPad::setup(const TouchPadSettings& settings)
+{
+    _deviceManager.stop();
+
+    // Release the current source first, as only one MultitouchSupport
+    // source may exist at a time.
+    installFrameSource(std::unique_ptr<FrameSource>(new SyntheticFrameSource(0)));
+
+    std::unique_ptr<FrameSource> source;
+
+    switch (settings.backend)
+    {
+        case TouchPadSettings::BACKEND_DEFAULT:
+#if defined(TARGET_OSX)
+            source.reset(new MultitouchSupportFrameSource());
+#elif defined(__linux__)
+            source.reset(new EvdevFrameSource());
+#else
+            source.reset(new SyntheticFrameSource());
+#endif
+            break;
+        case TouchPadSettings::BACKEND_MULTITOUCH_SUPPORT:
+#if defined(TARGET_OSX)
+            source.reset(new MultitouchSupportFrameSource());
+#endif
+            break;
+        case TouchPadSettings::BACKEND_EVDEV:
+#if defined(__linux__)
+            source.reset(new EvdevFrameSource());
+#endif
+            break;
+        case TouchPadSettings::BACKEND_SYNTHETIC:
+            source.reset(new SyntheticFrameSource());
+            break;
+    }
+
+    if (!source)
+    {
+        ofLogError("TouchPad::setup") << "Backend " << settings.backend << " is not available on this platform.";
+        return false;
+    }
+
+    DeviceManagerSettings watchSettings;
+    watchSettings.watch = settings.watchDevices;
+    watchSettings.pollInterval = settings.pollInterval;
+    watchSettings.autoConnect = settings.autoConnect;
+    watchSettings.autoConnectDeviceIds = settings.deviceIds;
+
+    if (settings.async)
+    {
+        // The watcher's first scan enumerates and connects the devices.
+        installFrameSource(std::move(source));
+        return startDeviceWatcher(watchSettings);
+    }
+
+    setFrameSource(std::move(source));
+
+    if (settings.autoConnect)
+    {
+        for (std::size_t i = 0; i < numDevices(); ++i)
         {
-            // Other states are available, but we skip them.
-            continue;
+            const std::vector<int>& ids = settings.deviceIds;
+
+            if (frameSource().isPresent(i)
+             && (ids.empty() || std::find(ids.begin(), ids.end(), static_cast<int>(i)) != ids.end()))
+            {
+                connect(i);
+            }
+        }
+    }
+
+    return !settings.watchDevices || startDeviceWatcher(watchSettings);
+}
+
+
+std::size_t TouchPad::numDevices() const
+{
+    std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+    return _frameSource->numDevices();
+}
+
+
+std::size_t TouchPad::getNumDevices() const
+{
+    return numDevices();
+}
+
+
+bool TouchPad::connect(int deviceId)
+{
+    DeviceEventArgs args;
+
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+        // Devices may have been found since the states were allocated.
+        allocateDeviceStates();
+
+        DeviceState* state = deviceState(deviceId);
+
+        if (state == nullptr)
+        {
+            ofLogWarning("TouchPad::connect") << "No device with id " << deviceId << ".";
+            return false;
         }
 
-        if (touchEvt.id >= 0)
+        state->acceptsFrames = true;
+        _deviceManager.setConnectionWanted(deviceId, true);
+
+        if (!_frameSource->connect(deviceId))
         {
-            touchEvents.push_back(touchEvt);
+            return false;
+        }
+
+        args = deviceEventArgs(deviceId);
+    }
+
+    _deviceManager.post(DeviceManager::DEVICE_CONNECTED, args);
+    return true;
+}
+
+
+bool TouchPad::disconnect(int deviceId)
+{
+    DeviceEventArgs args;
+
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+        // Set before the source disconnects, so the watcher's scans, which
+        // hold the same lock, never take this for a device plugged back in.
+        _deviceManager.setConnectionWanted(deviceId, false);
+
+        if (!_frameSource->disconnect(deviceId))
+        {
+            return false;
+        }
+
+        args = deviceEventArgs(deviceId);
+    }
+
+    // No more frames will arrive, so cancel any touches left on the pad.
+    // This is done without the lock, as input thread listeners may
+    // disconnect too.
+    cancelTouches(deviceId);
+
+    _deviceManager.post(DeviceManager::DEVICE_DISCONNECTED, args);
+    return true;
+}
+
+
+void TouchPad::cancelTouches(int deviceId)
+{
+    DeviceState* state = deviceState(deviceId);
+
+    if (state == nullptr)
+    {
+        return;
+    }
+
+    DeviceState& device = *state;
+
+    // Refuse late frames, then let the callbacks and the input thread finish
+    // the frames that arrived before, so none of them runs with or follows
+    // the cancel.
+    device.acceptsFrames = false;
+    waitForFrameCallbacks();
+    _inputThread.flush();
+
+    ContactFrame& frame = device.frame;
+    frame.deviceId = deviceId;
+    frame.receivedTime = std::chrono::steady_clock::now();
+    frame.touches.clear();
+    frame.hovers.clear();
+    frame.history.clear();
+
+    device.phases.cancelAll(frame);
+    device.filter.reset();
+    device.kinematics.reset();
+
+    if (!frame.touches.empty() || !frame.hovers.empty())
+    {
+        if (getDispatchMode() != DISPATCH_IMMEDIATE)
+        {
+            _frameQueue.push(frame);
         }
         else
         {
-            ofLogError("TouchPad::mt_callback") << "Callback produced an id < 0.";
+            registerTouchEvents(frame);
         }
-        
+    }
+}
+
+
+void TouchPad::waitForFrameCallbacks() const
+{
+    // A listener may disconnect from inside a frame callback.
+    const int ownCallbacks = callbackTouchPad == this ? callbackDepth : 0;
+
+    while (_activeCallbacks.load() > ownCallbacks)
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+void TouchPad::allocateDeviceStates()
+{
+    std::size_t numDeviceStates = _numDeviceStates.load();
+    std::size_t numDevices = std::min<std::size_t>(_frameSource->numDevices(), MAX_DEVICES);
+
+    if (_frameSource->numDevices() > MAX_DEVICES && numDeviceStates < MAX_DEVICES)
+    {
+        ofLogWarning("TouchPad::allocateDeviceStates") << "Only the first " << MAX_DEVICES << " devices can be used.";
+    }
+
+    for (std::size_t i = numDeviceStates; i < numDevices; ++i)
+    {
+        _deviceStates[i].reset(new DeviceState());
+        applyLoadedCalibration(i);
     }
 
-    if (!touchEvents.empty())
+    if (numDevices > numDeviceStates)
     {
-        pad.registerTouchEvents(touchEvents);
+        // Publish the new states to the frame threads.
+        _numDeviceStates.store(numDevices, std::memory_order_release);
     }
 }
 
 
-void TouchPad::registerTouchEvents(const Touches& touchEvents)
+TouchPad::DeviceState* TouchPad::deviceState(int deviceId) const
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    
-    _activeTouches.clear();
-    
-    auto now = ofGetElapsedTimeMillis();
+    if (deviceId < 0 || deviceId >= static_cast<int>(_numDeviceStates.load(std::memory_order_acquire)))
+    {
+        return nullptr;
+    }
+
+    return _deviceStates[deviceId].get();
+}
+
+
+void TouchPad::applyLoadedCalibration(int deviceId)
+{
+    auto iter = _loadedCalibrations.find(_frameSource->deviceIdentity(deviceId));
+
+    if (iter != _loadedCalibrations.end())
+    {
+        _deviceStates[deviceId]->calibration.fromJson(iter->second);
+    }
+}
+
+
+DeviceEventArgs TouchPad::deviceEventArgs(int deviceId) const
+{
+    std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+    DeviceEventArgs args;
+    args.deviceId = deviceId;
+    args.identity = _frameSource->deviceIdentity(deviceId);
+    args.name = _frameSource->deviceName(deviceId);
+    args.isConnected = _frameSource->isConnected(deviceId);
+    return args;
+}
+
+
+void TouchPad::disconnectAll()
+{
+    for (std::size_t i = 0; i < numDevices(); ++i)
+    {
+        bool isConnected = false;
+
+        {
+            std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+            isConnected = _frameSource->isConnected(i);
+        }
+
+        if (isConnected && !disconnect(i))
+        {
+            ofLogError("TouchPad::disconnectAll") << "Unable to disconnect from " << i;
+        }
+    }
+}
+
+
+void TouchPad::setFrameSource(std::unique_ptr<FrameSource> source)
+{
+    // The watcher uses the current source, so restart it afterwards.
+    DeviceManagerSettings watchSettings = _deviceManager.settings();
+    bool isWatching = _deviceManager.isRunning() && watchSettings.watch;
+    _deviceManager.stop();
+
+    installFrameSource(std::move(source));
+
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+        _frameSource->refreshDeviceList();
+
+        // Allocate the device state before any frames can arrive.
+        allocateDeviceStates();
+    }
+
+    if (isWatching)
+    {
+        startDeviceWatcher(watchSettings);
+    }
+}
+
+
+void TouchPad::installFrameSource(std::unique_ptr<FrameSource> source)
+{
+    if (_frameSource)
+    {
+        disconnectAll();
+    }
+
+    // Hide the old states, then wait for the frame threads that may still be
+    // using them.
+    _numDeviceStates = 0;
+    waitForFrameCallbacks();
+    _inputThread.flush();
+
+    std::unique_lock<std::recursive_mutex> sourceLock(_sourceMutex);
+
+    _frameSource = std::move(source);
+    _hasSteadyTimestamps = _frameSource->hasSteadyTimestamps();
+
+    for (auto& device: _deviceStates)
+    {
+        device.reset();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_dispatchMutex);
+        _activeTouches.clear();
+    }
 
-    for (std::size_t i = 0; i < touchEvents.size(); ++i)
+    _frameSource->setFrameCallback([this](int deviceId,
+                                          const MTTouch* touches,
+                                          int32_t numTouches,
+                                          double timestamp,
+                                          int32_t frameNum)
     {
-        ofTouchEventArgs t = touchEvents[i];
-        
-        if (t.type == ofTouchEventArgs::down)
+        // Counted before the state is looked up, so that a thread that
+        // waits for the callbacks after hiding a state sees this one.
+        _activeCallbacks.fetch_add(1);
+
+        const TouchPad* outerTouchPad = callbackTouchPad;
+        const int outerDepth = callbackDepth;
+        callbackDepth = outerTouchPad == this ? outerDepth + 1 : 1;
+        callbackTouchPad = this;
+
+        DeviceState* state = deviceState(deviceId);
+
+        if (state != nullptr && state->acceptsFrames)
         {
-            if ((now - _tapCounts[t.id].lastTap) < _doubleTapSpeed)
+            if (_inputThread.isRunning())
             {
-                _tapCounts[t.id].tapCount++;
+                _inputThread.push(deviceId, touches, numTouches, timestamp, frameNum);
             }
             else
             {
-                _tapCounts[t.id].tapCount = 1;
+                processFrame(deviceId, touches, numTouches, timestamp, frameNum, std::chrono::steady_clock::now());
             }
-            
-            _tapCounts[t.id].lastTap = now; // register last tap time
-            
-            if (_tapCounts[t.id].tapCount == 2)
+        }
+
+        callbackTouchPad = outerTouchPad;
+        callbackDepth = outerDepth;
+        _activeCallbacks.fetch_sub(1);
+    });
+}
+
+
+bool TouchPad::startDeviceWatcher(const DeviceManagerSettings& settings)
+{
+    return _deviceManager.start(settings, [this]()
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+        _frameSource->refreshDeviceList();
+        allocateDeviceStates();
+
+        std::vector<DeviceEventArgs> devices;
+
+        for (std::size_t i = 0; i < _frameSource->numDevices(); ++i)
+        {
+            if (_frameSource->isPresent(i))
             {
-                t.type = ofTouchEventArgs::doubleTap;
-                ofNotifyEvent(ofEvents().touchDoubleTap, t);
+                devices.push_back(deviceEventArgs(i));
             }
+        }
+
+        return devices;
+    },
+    [this](int deviceId)
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+        if (!_frameSource->isConnected(deviceId))
+        {
+            connect(deviceId);
+        }
+    },
+    [this](int deviceId)
+    {
+        // A removed device may have been disconnected by its source
+        // already, leaving its touches behind.
+        if (!disconnect(deviceId))
+        {
+            cancelTouches(deviceId);
+        }
+    });
+}
+
+
+void TouchPad::stopDeviceWatcher()
+{
+    _deviceManager.stop();
+}
+
+
+bool TouchPad::isDeviceWatcherRunning() const
+{
+    return _deviceManager.isRunning();
+}
+
+
+void TouchPad::connectAsync(int deviceId)
+{
+    if (!_deviceManager.isRunning())
+    {
+        DeviceManagerSettings settings;
+        settings.watch = false;
+        settings.autoConnect = false;
+        startDeviceWatcher(settings);
+    }
+
+    _deviceManager.connect(deviceId);
+}
+
 
-            t.type = ofTouchEventArgs::down;
-            ofNotifyEvent(ofEvents().touchDown, t);
-            _activeTouches[touchEvents[i].id] = touchEvents[i];
+void TouchPad::disconnectAsync(int deviceId)
+{
+    if (!_deviceManager.isRunning())
+    {
+        DeviceManagerSettings settings;
+        settings.watch = false;
+        settings.autoConnect = false;
+        startDeviceWatcher(settings);
+    }
+
+    _deviceManager.disconnect(deviceId);
+}
+
+
+DeviceEvents& TouchPad::deviceEvents()
+{
+    return _deviceEvents;
+}
+
+
+bool TouchPad::startInputThread(const InputThreadSettings& settings)
+{
+    return _inputThread.start(settings, [this](int deviceId,
+                                               const MTTouch* touches,
+                                               int32_t numTouches,
+                                               double timestamp,
+                                               int32_t frameNum,
+                                               std::chrono::steady_clock::time_point receivedTime)
+    {
+        processFrame(deviceId, touches, numTouches, timestamp, frameNum, receivedTime);
+    });
+}
+
+
+void TouchPad::stopInputThread()
+{
+    _inputThread.stop();
+}
+
+
+bool TouchPad::isInputThreadRunning() const
+{
+    return _inputThread.isRunning();
+}
+
+
+FrameSource& TouchPad::frameSource()
+{
+    return *_frameSource;
+}
+
+
+const FrameSource& TouchPad::frameSource() const
+{
+    return *_frameSource;
+}
+
+
+const DeviceCalibration* TouchPad::calibration(int deviceId) const
+{
+    const DeviceState* device = deviceState(deviceId);
+    return device != nullptr ? &device->calibration : nullptr;
+}
+
+
+void TouchPad::resetCalibration(int deviceId)
+{
+    if (DeviceState* device = deviceState(deviceId))
+    {
+        device->calibration.reset();
+    }
+    else
+    {
+        ofLogWarning("TouchPad::resetCalibration") << "No device with id " << deviceId << ".";
+    }
+}
+
+
+bool TouchPad::loadCalibration(const std::string& path)
+{
+    ofJson json = ofLoadJson(path);
+
+    if (!json.is_object() || json.count("devices") == 0 || !json["devices"].is_array())
+    {
+        ofLogError("TouchPad::loadCalibration") << "Unable to load calibration from " << path << ".";
+        return false;
+    }
+
+    std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+    for (const auto& device: json["devices"])
+    {
+        int deviceId = device.value("id", -1);
+        std::string identity = device.value("identity", std::string());
+
+        // Older files only have the id.
+        if (identity.empty() && deviceId >= 0 && deviceId < static_cast<int>(_frameSource->numDevices()))
+        {
+            identity = _frameSource->deviceIdentity(deviceId);
         }
-        else if (t.type == ofTouchEventArgs::move)
+
+        DeviceCalibration calibration;
+
+        if (identity.empty())
         {
-            ofNotifyEvent(ofEvents().touchMoved, t);
-            _activeTouches[touchEvents[i].id] = touchEvents[i];
+            ofLogWarning("TouchPad::loadCalibration") << "Skipping calibration for unknown device " << deviceId << ".";
         }
-        else if (t.type == ofTouchEventArgs::up)
+        else if (!calibration.fromJson(device))
         {
-            ofNotifyEvent(ofEvents().touchUp, t);
+            ofLogWarning("TouchPad::loadCalibration") << "Skipping invalid calibration for device " << identity << ".";
         }
         else
         {
-            //
+            ofJson& loaded = _loadedCalibrations[identity];
+            loaded = device;
+            loaded["identity"] = identity;
         }
     }
-}
-
 
+    // Devices found later get theirs when their state is allocated.
+    std::size_t numDeviceStates = _numDeviceStates.load(std::memory_order_acquire);
 
-TouchPad::TouchPad():
-    _scalingMode(SCALE_TO_WINDOW),
-    _scalingRectangle(ofRectangle(0,0,ofGetWidth(),ofGetHeight())),
-    _doubleTapSpeed(DEFAULT_DOUBLE_TAP_SPEED),
-    _exitListener(ofEvents().exit.newListener(this, &TouchPad::exit))
-{
-    for (std::size_t i = 0; i < MAX_TOUCHES; ++i)
+    for (std::size_t i = 0; i < numDeviceStates; ++i)
     {
-        _tapCounts[i] = TapCount();
+        applyLoadedCalibration(i);
     }
 
-    refreshDeviceList();
-    connect(); // connect to default device
+    return true;
 }
 
 
-bool TouchPad::connect(int deviceId)
+bool TouchPad::saveCalibration(const std::string& path) const
 {
-    if (0 != _deviceList && deviceId >= 0 && deviceId < _nDevices)
-    {
-        if (_devices.find(deviceId) == _devices.end())
-        {
-            // get the device reference
-            MTDeviceRef mtDeviceRef = (MTDeviceRef)CFArrayGetValueAtIndex(_deviceList, deviceId);
-            // register the callback for the reference
-            MTRegisterContactFrameCallback(mtDeviceRef, mt_callback);
-            // start the device
-            MTDeviceStart(mtDeviceRef);
-            // store a reference w/ a device number
+    ofJson json;
+    json["devices"] = ofJson::array();
 
-            int32_t width  = -1;
-            int32_t height = -1;
-            
-            OSStatus err = MTDeviceGetSensorSurfaceDimensions(mtDeviceRef, &width, &height);
+    std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
 
-            ofRectangle rect;
+    // Keep the loaded calibrations of devices that aren't present.
+    std::map<std::string, ofJson> calibrations = _loadedCalibrations;
 
-            if (!err)
-			{
-                rect.set(0, 0, width / 100.0f, height / 100.0f);
-            }
-			else
-			{
-                ofLogError("TouchPad::connect") << "Unable to get device dimensions.";
-            }
-            
-            _devices[deviceId] = new DeviceInfo(mtDeviceRef, deviceId, rect);
-            
-            // printDeviceInfo(mtDeviceRef);
+    std::size_t numDeviceStates = _numDeviceStates.load(std::memory_order_acquire);
 
-            return true;
-        }
-        else
-        {
-            ofLogWarning("TouchPad::connect") << "Already connected to device " << deviceId << ".";
-            return false;
-        }
+    for (std::size_t i = 0; i < numDeviceStates; ++i)
+    {
+        std::string identity = _frameSource->deviceIdentity(i);
+        ofJson device = _deviceStates[i]->calibration.toJson();
+        device["id"] = i;
+        device["identity"] = identity;
+        calibrations[identity] = device;
     }
-    else
+
+    for (const auto& calibration: calibrations)
     {
-        ofLogWarning("TouchPad::connect") << "No multitouch devices available.";
-        return false;
+        json["devices"].push_back(calibration.second);
     }
+
+    return ofSavePrettyJson(path, json);
 }
 
 
-bool TouchPad::disconnect(int deviceId)
+const DeviceStats* TouchPad::stats(int deviceId) const
 {
-    if (_deviceList != nullptr && deviceId >= 0 && deviceId < _nDevices)
-    {
-        auto iter = _devices.find(deviceId);
+    const DeviceState* device = deviceState(deviceId);
+    return device != nullptr ? &device->stats : nullptr;
+}
 
-        if (iter != _devices.end())
-        {
-            MTDeviceStop(iter->second->ref);
-            MTUnregisterContactFrameCallback(iter->second->ref, mt_callback);
-            MTDeviceRelease(iter->second->ref);
-            delete iter->second; // deallocate
-            _devices.erase(iter); // remove it from the list
-            return true;
-        }
-        else
-        {
-            ofLogWarning("TouchPad::disconnect") << "Not connected to device " << deviceId << ".";
-            return false;
-        }
+
+void TouchPad::resetStats()
+{
+    std::size_t numDeviceStates = _numDeviceStates.load(std::memory_order_acquire);
+
+    for (std::size_t i = 0; i < numDeviceStates; ++i)
+    {
+        _deviceStates[i]->stats.reset();
     }
-    else
+}
+
+
+ofJson TouchPad::statsJson() const
+{
+    ofJson json;
+    json["source"] = frameSource().name();
+    json["queue"]["depth"] = queueDepth();
+    json["queue"]["overflow_count"] = queueOverflowCount();
+    json["queue"]["dropped_frames"] = queueDroppedFrameCount();
+    json["input_thread"]["running"] = isInputThreadRunning();
+    json["input_thread"]["depth"] = _inputThread.size();
+    json["input_thread"]["processed_frames"] = _inputThread.processedFrameCount();
+    json["input_thread"]["dropped_frames"] = _inputThread.droppedFrameCount();
+    json["devices"] = ofJson::array();
+
+    std::size_t numDeviceStates = _numDeviceStates.load(std::memory_order_acquire);
+
+    for (std::size_t i = 0; i < numDeviceStates; ++i)
     {
-        ofLogWarning("TouchPad::disconnect") << "No multitouch devices available.";
-        return false;
+        ofJson device = _deviceStates[i]->stats.toJson();
+        device["id"] = i;
+        json["devices"].push_back(device);
     }
+
+    return json;
 }
 
 
-std::size_t TouchPad::getNumDevices() const
+bool TouchPad::saveStats(const std::string& path) const
+{
+    return ofSavePrettyJson(path, statsJson());
+}
+
+
+TouchRecorder& TouchPad::recorder()
 {
-    return _nDevices;
+    return _recorder;
 }
 
 
 TouchPad::~TouchPad()
 {
+    // The threads use the members destroyed after this, so stop them all
+    // first: the watcher, then the device callbacks, then the input thread.
+    _deviceManager.stop();
+
+    {
+        std::unique_lock<std::recursive_mutex> lock(_sourceMutex);
+
+        if (_frameSource)
+        {
+            for (std::size_t i = 0; i < _frameSource->numDevices(); ++i)
+            {
+                if (_frameSource->isConnected(i))
+                {
+                    _frameSource->disconnect(i);
+                }
+            }
+
+            _frameSource.reset();
+        }
+    }
+
+    _inputThread.stop();
 }
 
 
@@ -338,31 +1164,67 @@ void TouchPad::exit(ofEventArgs& etc)
         enableOSGestureSupport();
     }
 
-    auto iter = _devices.begin();
+    _deviceManager.stop();
+
+    disconnectAll();
+
+    _inputThread.stop();
+    _recorder.stop();
+
+    ofLogVerbose("TouchPad::~TouchPad") << "Multitouch devices have been disconnected.";
+}
+
 
-    while (iter != _devices.end())
+void TouchPad::update(ofEventArgs& etc)
+{
+    _deviceManager.update(_deviceEvents);
+
+    // Bound the work so that a fast producer can't hold up the update.
+    std::size_t remaining = _frameQueue.capacity() + 1;
+
+    if (getDispatchMode() == DISPATCH_COALESCED)
     {
-        if (!disconnect(iter->first))
+        if (!_frameQueue.pop(_dispatchFrame))
         {
-            ofLogError("TouchPad::~TouchPad") << "Unable to disconnect from " << iter->first;
+            return;
         }
-        else
+
+        // Fire every frame since the last update as one.
+        while (--remaining > 0 && _frameQueue.pop(_coalesceFrame))
         {
-            // Successfully disconnected;
-            return;
+            ContactFrameQueue::coalesce(_dispatchFrame, _coalesceFrame);
         }
 
-        ++iter;
+        registerTouchEvents(_dispatchFrame);
+        return;
     }
 
-    ofLogVerbose("TouchPad::~TouchPad") << "Multitouch devices have been disconnected.";
+    while (remaining-- > 0 && _frameQueue.pop(_dispatchFrame))
+    {
+        registerTouchEvents(_dispatchFrame);
+    }
+}
+
+
+void TouchPad::onTap(TapEventArgs& tap)
+{
+    if (tap.numTouches == 1 && tap.tapCount == 2 && areCoreTouchEventsEnabled())
+    {
+        ofTouchEventArgs touch;
+        touch.type = ofTouchEventArgs::doubleTap;
+        touch.id = tap.touchId;
+        touch.numTouches = 1;
+        touch.x = tap.position.x;
+        touch.y = tap.position.y;
+        ofNotifyEvent(ofEvents().touchDoubleTap, touch);
+    }
 }
 
 
 std::size_t TouchPad::touchCount() const
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    return _activeTouches.size();
+    std::unique_lock<std::mutex> lock(_legacySnapshotMutex);
+    return _legacySnapshots.front().size();
 }
 
 
@@ -374,16 +1236,9 @@ std::size_t TouchPad::getTouchCount() const
 
 TouchPad::Touches TouchPad::touches() const
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-
-    Touches touches;
-
-    for (const auto& touch: _activeTouches)
-    {
-        touches.push_back(touch.second);
-    }
-
-    return touches;
+    std::unique_lock<std::mutex> lock(_legacySnapshotMutex);
+    const TouchSnapshot& touchSnapshot = _legacySnapshots.front();
+    return Touches(touchSnapshot.begin(), touchSnapshot.end());
 }
 
 
@@ -395,8 +1250,16 @@ TouchPad::Touches TouchPad::getTouches() const
 
 TouchPad::TouchMap TouchPad::touchMap() const
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    return _activeTouches;
+    TouchMap touchMap;
+
+    std::unique_lock<std::mutex> lock(_legacySnapshotMutex);
+
+    for (const auto& touch: _legacySnapshots.front())
+    {
+        touchMap[touch.id] = touch;
+    }
+
+    return touchMap;
 }
 
 
@@ -408,35 +1271,74 @@ TouchPad::TouchMap TouchPad::getTouchMap() const
 
 bool TouchPad::hasTouchId(int touchId) const
 {
-    std::unique_lock<std::mutex> lock(_mutex);
-    return _activeTouches.find(touchId) != _activeTouches.end();
+    std::unique_lock<std::mutex> lock(_legacySnapshotMutex);
+
+    for (const auto& touch: _legacySnapshots.front())
+    {
+        if (touch.id == touchId)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+const TouchSnapshot& TouchPad::snapshot() const
+{
+    return _snapshots.front();
 }
 
 
 uint64_t TouchPad::getDoubleTapSpeed() const
 {
-    return _doubleTapSpeed;
+    return static_cast<uint64_t>(getTapSettings().multiTapInterval * 1000 + 0.5);
 }
 
 
 void TouchPad::setDoubleTapSpeed(uint64_t doubleTapSpeed)
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    _doubleTapSpeed = doubleTapSpeed;
+    PipelineSettings settings = _settings.load();
+    settings.taps.multiTapInterval = doubleTapSpeed / 1000.0;
+    _settings.store(settings);
 }
 
 
-TouchPad::ScalingMode TouchPad::getScalingMode() const
+TapEvents& TouchPad::tapEvents()
+{
+    return _tapEvents;
+}
+
+
+TapSettings TouchPad::getTapSettings() const
+{
+    return _settings.load().taps;
+}
+
+
+void TouchPad::setTapSettings(const TapSettings& settings)
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    return _scalingMode;
+    PipelineSettings pipelineSettings = _settings.load();
+    pipelineSettings.taps = settings;
+    _settings.store(pipelineSettings);
+}
+
+
+TouchPad::ScalingMode TouchPad::getScalingMode() const
+{
+    return _settings.load().scalingMode;
 }
 
 
 void TouchPad::setScalingMode(ScalingMode scalingMode)
 {
     std::unique_lock<std::mutex> lock(_mutex);
-    _scalingMode = scalingMode;
+    PipelineSettings settings = _settings.load();
+    settings.scalingMode = scalingMode;
+    _settings.store(settings);
 }
 
 
@@ -451,6 +1353,169 @@ void TouchPad::setScalingRect(const ofRectangle& scalingRectangle)
 {
     std::unique_lock<std::mutex> lock(_mutex);
     _scalingRectangle = scalingRectangle;
+
+    PipelineSettings settings = _settings.load();
+    settings.scalingRect[0] = scalingRectangle.x;
+    settings.scalingRect[1] = scalingRectangle.y;
+    settings.scalingRect[2] = scalingRectangle.width;
+    settings.scalingRect[3] = scalingRectangle.height;
+    _settings.store(settings);
+}
+
+
+FilterSettings TouchPad::getFilterSettings() const
+{
+    return _filterSettings.load();
+}
+
+
+void TouchPad::setFilterSettings(const FilterSettings& settings)
+{
+    _filterSettings.store(settings);
+}
+
+
+KinematicsSettings TouchPad::getKinematicsSettings() const
+{
+    return _settings.load().kinematics;
+}
+
+
+void TouchPad::setKinematicsSettings(const KinematicsSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    PipelineSettings pipelineSettings = _settings.load();
+    pipelineSettings.kinematics = settings;
+    _settings.store(pipelineSettings);
+}
+
+
+TouchPad::DispatchMode TouchPad::getDispatchMode() const
+{
+    return static_cast<DispatchMode>(_dispatchMode.load(std::memory_order_relaxed));
+}
+
+
+void TouchPad::setDispatchMode(DispatchMode dispatchMode)
+{
+    _dispatchMode.store(dispatchMode, std::memory_order_relaxed);
+}
+
+
+ContactFrameQueue::OverflowPolicy TouchPad::getQueueOverflowPolicy() const
+{
+    return _frameQueue.getOverflowPolicy();
+}
+
+
+void TouchPad::setQueueOverflowPolicy(ContactFrameQueue::OverflowPolicy policy)
+{
+    _frameQueue.setOverflowPolicy(policy);
+}
+
+
+std::size_t TouchPad::queueDepth() const
+{
+    return _frameQueue.size();
+}
+
+
+uint64_t TouchPad::queueOverflowCount() const
+{
+    return _frameQueue.overflowCount();
+}
+
+
+uint64_t TouchPad::queueDroppedFrameCount() const
+{
+    return _frameQueue.droppedFrameCount();
+}
+
+
+GestureEvents& TouchPad::gestureEvents()
+{
+    return _gestureEvents;
+}
+
+
+ofEvent<const ContactFrame>& TouchPad::frameEvent()
+{
+    return _frameEvent;
+}
+
+
+ofEvent<const RawFrame>& TouchPad::rawFrameEvent()
+{
+    return _rawFrameEvent;
+}
+
+
+void TouchPad::disableFrameConversion()
+{
+    _isFrameConversionEnabled = false;
+}
+
+
+void TouchPad::enableFrameConversion()
+{
+    _isFrameConversionEnabled = true;
+}
+
+
+bool TouchPad::isFrameConversionEnabled() const
+{
+    return _isFrameConversionEnabled.load(std::memory_order_relaxed);
+}
+
+
+void TouchPad::disableCoreTouchEvents()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    PipelineSettings settings = _settings.load();
+    settings.isCoreTouchEventsEnabled = false;
+    _settings.store(settings);
+}
+
+
+void TouchPad::enableCoreTouchEvents()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    PipelineSettings settings = _settings.load();
+    settings.isCoreTouchEventsEnabled = true;
+    _settings.store(settings);
+}
+
+
+bool TouchPad::areCoreTouchEventsEnabled() const
+{
+    return _settings.load().isCoreTouchEventsEnabled;
+}
+
+
+const TouchHistory& TouchPad::history() const
+{
+    return _dispatchHistory != nullptr ? *_dispatchHistory : _emptyHistory;
+}
+
+
+ofEvent<ofTouchEventArgs>& TouchPad::hoverEvent()
+{
+    return _hoverEvent;
+}
+
+
+GestureSettings TouchPad::getGestureSettings() const
+{
+    return _settings.load().gestures;
+}
+
+
+void TouchPad::setGestureSettings(const GestureSettings& settings)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    PipelineSettings pipelineSettings = _settings.load();
+    pipelineSettings.gestures = settings;
+    _settings.store(pipelineSettings);
 }
 
 
@@ -537,82 +1602,9 @@ std::string TouchPad::touchPhaseToString(MTTouchPhase phase)
 }
 
 
-void TouchPad::printDeviceInfo(MTDeviceRef deviceRef)
-{
-    ofLogVerbose("TouchPad::printDeviceInfo") << "-------------------";
-
-    uuid_t guid;
-
-    if (!MTDeviceGetGUID(deviceRef, &guid))
-    {
-        uuid_string_t val;
-        uuid_unparse(guid, val);
-        ofLogNotice("TouchPad::printDeviceInfo") << val;
-    }
-
-    bool supportsActuation = MTDeviceSupportsActuation(deviceRef);
-    bool supportsForce = MTDeviceSupportsForce(deviceRef);
-
-    ofLogVerbose("TouchPad::printDeviceInfo") << "Supports Actuation: " << supportsActuation;
-    ofLogVerbose("TouchPad::printDeviceInfo") << "Supports Force: " << supportsForce;
-
-    int a;
-
-    if (!MTDeviceGetDriverType(deviceRef, &a))
-    {
-        ofLogVerbose("TouchPad::printDeviceInfo") << "Driver type: " << a;
-
-        int _a;
-//        if (!MTDeviceGetActualType(deviceRef, &_a))
-//        {
-//            ofLogVerbose("TouchPad::printDeviceInfo") << "Actual Driver type: " << _a;
-//        }
-    }
-    
-    if (MTDeviceGetDeviceID)
-    {
-        uint64_t devID;
-        
-        if (!MTDeviceGetDeviceID(deviceRef, &devID))
-        {
-            ofLogVerbose("TouchPad::printDeviceInfo") << "Device ID: " << devID;
-        }
-    }
-
-    if (!MTDeviceGetFamilyID(deviceRef, &a))
-    {
-        ofLogVerbose("TouchPad::printDeviceInfo") << "Family ID: " << a;
-    }
-    
-    int b;
-
-    if (!MTDeviceGetSensorSurfaceDimensions(deviceRef, &a, &b))
-    {
-        ofLogVerbose("TouchPad::printDeviceInfo") << "Dimensions: " << a / 100.0f << " x " << b / 100.0;
-    }
-
-    if (!MTDeviceGetSensorDimensions(deviceRef, &a, &b))
-    {
-        ofLogVerbose("TouchPad::printDeviceInfo") << "Rows: " << a << " Columns: " << b;
-    }
-
-    if (MTDeviceIsBuiltIn)
-    {
-        if (MTDeviceIsBuiltIn(deviceRef))
-        {
-            ofLogVerbose("TouchPad::printDeviceInfo") << "Is device built-in: YES";
-        }
-        else
-        {
-            ofLogVerbose("TouchPad::printDeviceInfo") << "Is device built-in: NO";
-        }
-    }
-}
-
-
 TouchPad& TouchPad::instance()
 {
-    static TouchPad sh;
+    static TouchPad sh { TouchPadSettings() };
     return sh;
 }
 
@@ -0,0 +1,211 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchPadStats.h"
+#include <algorithm>
+#include <limits>
+
+
+namespace ofx {
+
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    _buckets[bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t current = _min.load(std::memory_order_relaxed);
+
+    while (nanoseconds < current
+        && !_min.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+
+    current = _max.load(std::memory_order_relaxed);
+
+    while (nanoseconds > current
+        && !_max.compare_exchange_weak(current, nanoseconds, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+uint64_t LatencyHistogram::count() const
+{
+    return _count.load(std::memory_order_relaxed);
+}
+
+
+uint64_t LatencyHistogram::min() const
+{
+    return count() > 0 ? _min.load(std::memory_order_relaxed) : 0;
+}
+
+
+uint64_t LatencyHistogram::max() const
+{
+    return _max.load(std::memory_order_relaxed);
+}
+
+
+double LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    return n > 0 ? double(_sum.load(std::memory_order_relaxed)) / n : 0;
+}
+
+
+uint64_t LatencyHistogram::percentile(double percentile) const
+{
+    uint64_t n = count();
+
+    if (n == 0)
+    {
+        return 0;
+    }
+
+    // The rank of the percentile, counting from 1.
+    double clamped = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * n + 0.5));
+    uint64_t seen = 0;
+
+    for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+
+        if (seen >= rank)
+        {
+            return std::min(bucketMax(i), max());
+        }
+    }
+
+    return max();
+}
+
+
+void LatencyHistogram::reset()
+{
+    for (auto& bucket: _buckets)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+
+ofJson LatencyHistogram::toJson() const
+{
+    ofJson json;
+    json["count"] = count();
+    json["min_ns"] = min();
+    json["mean_ns"] = mean();
+    json["p50_ns"] = percentile(50);
+    json["p90_ns"] = percentile(90);
+    json["p99_ns"] = percentile(99);
+    json["p999_ns"] = percentile(99.9);
+    json["max_ns"] = max();
+    return json;
+}
+
+
+std::size_t LatencyHistogram::bucket(uint64_t value)
+{
+    if (value < SUB_BUCKET_COUNT)
+    {
+        return static_cast<std::size_t>(value);
+    }
+
+    // The position of the highest set bit.
+#if defined(__GNUC__)
+    std::size_t exponent = 63 - __builtin_clzll(value);
+#else
+    std::size_t exponent = 0;
+
+    for (uint64_t v = value >> 1; v != 0; v >>= 1)
+    {
+        ++exponent;
+    }
+#endif
+
+    if (exponent > MAX_EXPONENT)
+    {
+        return BUCKET_COUNT - 1;
+    }
+
+    std::size_t shift = exponent - SUB_BUCKET_BITS;
+    std::size_t subBucket = static_cast<std::size_t>(value >> shift) - SUB_BUCKET_COUNT;
+    return (shift + 1) * SUB_BUCKET_COUNT + subBucket;
+}
+
+
+uint64_t LatencyHistogram::bucketMax(std::size_t bucket)
+{
+    if (bucket < SUB_BUCKET_COUNT)
+    {
+        return bucket;
+    }
+
+    std::size_t shift = bucket / SUB_BUCKET_COUNT - 1;
+    uint64_t subBucket = bucket % SUB_BUCKET_COUNT;
+    return ((SUB_BUCKET_COUNT + subBucket + 1) << shift) - 1;
+}
+
+
+DeviceStats::DeviceStats()
+{
+    reset();
+}
+
+
+void DeviceStats::reset()
+{
+    framesReceived.store(0, std::memory_order_relaxed);
+    touchesConverted.store(0, std::memory_order_relaxed);
+    touchesDropped.store(0, std::memory_order_relaxed);
+    eventsDispatched.store(0, std::memory_order_relaxed);
+    untrackedEvents.store(0, std::memory_order_relaxed);
+    cancelsDropped.store(0, std::memory_order_relaxed);
+    callbackTime.reset();
+    dispatchTime.reset();
+    listenerTime.reset();
+    deliveryLatency.reset();
+    inputLatency.reset();
+    driverLatency.reset();
+}
+
+
+ofJson DeviceStats::toJson() const
+{
+    ofJson json;
+    json["frames_received"] = framesReceived.load(std::memory_order_relaxed);
+    json["touches_converted"] = touchesConverted.load(std::memory_order_relaxed);
+    json["touches_dropped"] = touchesDropped.load(std::memory_order_relaxed);
+    json["events_dispatched"] = eventsDispatched.load(std::memory_order_relaxed);
+    json["untracked_events"] = untrackedEvents.load(std::memory_order_relaxed);
+    json["cancels_dropped"] = cancelsDropped.load(std::memory_order_relaxed);
+    json["callback_time"] = callbackTime.toJson();
+    json["dispatch_time"] = dispatchTime.toJson();
+    json["listener_time"] = listenerTime.toJson();
+    json["delivery_latency"] = deliveryLatency.toJson();
+    json["input_latency"] = inputLatency.toJson();
+    json["driver_latency"] = driverLatency.toJson();
+    return json;
+}
+
+
+} // namespace ofx
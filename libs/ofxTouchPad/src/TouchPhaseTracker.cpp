@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchPhaseTracker.h"
+
+
+namespace ofx {
+
+
+TouchPhaseTracker::TouchPhaseTracker()
+{
+}
+
+
+void TouchPhaseTracker::beginFrame()
+{
+    ++_frameCount;
+    _updateCount = 0;
+}
+
+
+void TouchPhaseTracker::update(const ofTouchEventArgs& touch,
+                               const glm::vec2& predicted,
+                               MTTouchPhase phase,
+                               ContactFrame& frame)
+{
+    // The driver usually lists touches in the same order every frame.
+    Entry* entry = find(touch.id, _updateCount++);
+
+    if (entry == nullptr)
+    {
+        if (phase == MTTouchStateNotTracking
+         || phase == MTTouchStateBreakTouch
+         || phase == MTTouchStateOutOfRange
+         || _size == TouchBuffer::CAPACITY)
+        {
+            // Nothing to end, or nowhere to track it.
+            return;
+        }
+
+        entry = &_entries[_size++];
+        entry->state = STATE_NONE;
+    }
+
+    entry->frameCount = _frameCount;
+    entry->touch = touch;
+    entry->predicted = predicted;
+
+    switch (phase)
+    {
+        case MTTouchStateStartInRange:
+        case MTTouchStateHoverInRange:
+        case MTTouchStateLingerInRange:
+        {
+            if (entry->state == STATE_TOUCHING)
+            {
+                // The BreakTouch was missed.
+                append(frame.touches, touch, ofTouchEventArgs::up, predicted);
+                append(frame.hovers, touch, ofTouchEventArgs::down, predicted);
+            }
+            else
+            {
+                append(frame.hovers,
+                       touch,
+                       entry->state == STATE_HOVERING ? ofTouchEventArgs::move : ofTouchEventArgs::down,
+                       predicted);
+            }
+
+            entry->state = STATE_HOVERING;
+            break;
+        }
+        case MTTouchStateMakeTouch:
+        case MTTouchStateTouching:
+        {
+            if (entry->state == STATE_TOUCHING)
+            {
+                append(frame.touches, touch, ofTouchEventArgs::move, predicted);
+            }
+            else
+            {
+                if (entry->state == STATE_HOVERING)
+                {
+                    append(frame.hovers, touch, ofTouchEventArgs::up, predicted);
+                }
+
+                append(frame.touches, touch, ofTouchEventArgs::down, predicted);
+            }
+
+            entry->state = STATE_TOUCHING;
+            break;
+        }
+        case MTTouchStateBreakTouch:
+        {
+            if (entry->state == STATE_TOUCHING)
+            {
+                append(frame.touches, touch, ofTouchEventArgs::up, predicted);
+                append(frame.hovers, touch, ofTouchEventArgs::down, predicted);
+            }
+            else
+            {
+                append(frame.hovers, touch, ofTouchEventArgs::move, predicted);
+            }
+
+            entry->state = STATE_HOVERING;
+            break;
+        }
+        case MTTouchStateOutOfRange:
+        {
+            end(*entry, ofTouchEventArgs::up, frame);
+            entry->state = STATE_NONE;
+            break;
+        }
+        case MTTouchStateNotTracking:
+        default:
+        {
+            end(*entry, ofTouchEventArgs::cancel, frame);
+            entry->state = STATE_NONE;
+            break;
+        }
+    }
+}
+
+
+void TouchPhaseTracker::endFrame(ContactFrame& frame)
+{
+    for (std::size_t i = 0; i < _size;)
+    {
+        Entry& entry = _entries[i];
+
+        if (entry.frameCount != _frameCount)
+        {
+            // The touch was lost.
+            end(entry, ofTouchEventArgs::cancel, frame);
+            entry.state = STATE_NONE;
+        }
+
+        if (entry.state == STATE_NONE)
+        {
+            entry = _entries[--_size];
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+
+void TouchPhaseTracker::cancelAll(ContactFrame& frame)
+{
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        end(_entries[i], ofTouchEventArgs::cancel, frame);
+    }
+
+    _size = 0;
+}
+
+
+TouchPhaseTracker::State TouchPhaseTracker::state(int touchId) const
+{
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        if (_entries[i].touch.id == touchId)
+        {
+            return _entries[i].state;
+        }
+    }
+
+    return STATE_NONE;
+}
+
+
+std::size_t TouchPhaseTracker::size() const
+{
+    return _size;
+}
+
+
+TouchPhaseTracker::Entry* TouchPhaseTracker::find(int touchId, std::size_t hint)
+{
+    if (hint < _size && _entries[hint].touch.id == touchId)
+    {
+        return &_entries[hint];
+    }
+
+    for (std::size_t i = 0; i < _size; ++i)
+    {
+        if (_entries[i].touch.id == touchId)
+        {
+            return &_entries[i];
+        }
+    }
+
+    return nullptr;
+}
+
+
+void TouchPhaseTracker::end(const Entry& entry, ofTouchEventArgs::Type touchType, ContactFrame& frame)
+{
+    if (entry.state == STATE_TOUCHING)
+    {
+        append(frame.touches, entry.touch, touchType, entry.predicted);
+    }
+    else if (entry.state == STATE_HOVERING)
+    {
+        append(frame.hovers, entry.touch, ofTouchEventArgs::up, entry.predicted);
+    }
+}
+
+
+void TouchPhaseTracker::append(TouchBuffer& buffer,
+                               const ofTouchEventArgs& touch,
+                               ofTouchEventArgs::Type type,
+                               const glm::vec2& predicted)
+{
+    // Touches beyond the buffer capacity are dropped.
+    if (buffer.push_back(touch, predicted))
+    {
+        buffer[buffer.size() - 1].type = type;
+    }
+}
+
+
+} // namespace ofx
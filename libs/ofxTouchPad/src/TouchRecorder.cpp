@@ -0,0 +1,263 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchRecorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include "ofLog.h"
+#include "ofUtils.h"
+
+
+namespace ofx {
+
+
+TouchRecorder::TouchRecorder(std::size_t bufferSize):
+    _buffer(std::max<std::size_t>(bufferSize, TouchRecording::frameSize(256))),
+    _writePosition(0),
+    _isPushing(false),
+    _readPosition(0),
+    _isRecording(false),
+    _recordedFrameCount(0),
+    _droppedFrameCount(0),
+    _hasWriteError(false)
+{
+}
+
+
+TouchRecorder::~TouchRecorder()
+{
+    stop();
+}
+
+
+bool TouchRecorder::start(const std::string& path)
+{
+    stop();
+
+    _file = std::fopen(ofToDataPath(path, true).c_str(), "wb");
+
+    if (_file == nullptr)
+    {
+        ofLogError("TouchRecorder::start") << "Unable to open " << path << " for writing.";
+        return false;
+    }
+
+    TouchRecording::FileHeader header = TouchRecording::makeFileHeader();
+    std::vector<TouchRecording::FieldInfo> fields = TouchRecording::touchFields();
+
+    if (std::fwrite(&header, sizeof(header), 1, _file) != 1
+     || std::fwrite(fields.data(), sizeof(TouchRecording::FieldInfo), fields.size(), _file) != fields.size())
+    {
+        ofLogError("TouchRecorder::start") << "Unable to write the header of " << path << ": " << std::strerror(errno);
+        std::fclose(_file);
+        _file = nullptr;
+        return false;
+    }
+
+    // Recorders wait while the ring is reset.
+    lockPush();
+    _writePosition = 0;
+    _readPosition = 0;
+    _recordedFrameCount = 0;
+    _droppedFrameCount = 0;
+    _hasWriteError = false;
+    _isRecording = true;
+    unlockPush();
+
+    _thread = std::thread(&TouchRecorder::writerThread, this);
+
+    return true;
+}
+
+
+void TouchRecorder::stop()
+{
+    if (!_isRecording)
+    {
+        return;
+    }
+
+    // Once the lock is released, no recorder is copying a frame and none
+    // will start.
+    lockPush();
+    _isRecording = false;
+    unlockPush();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+
+    // Frames recorded while the writer was shutting down.
+    flush();
+
+    if (std::fclose(_file) != 0)
+    {
+        reportWriteError("close");
+    }
+
+    _file = nullptr;
+}
+
+
+bool TouchRecorder::isRecording() const
+{
+    return _isRecording.load(std::memory_order_relaxed);
+}
+
+
+bool TouchRecorder::record(int deviceId,
+                           const MTTouch* touches,
+                           int32_t numTouches,
+                           double timestamp,
+                           int32_t frameNum)
+{
+    if (!isRecording())
+    {
+        return false;
+    }
+
+    numTouches = std::max(numTouches, 0);
+
+    // Frames from several devices may arrive on different threads.
+    lockPush();
+
+    // Recording may have stopped since the check above.
+    if (!_isRecording.load(std::memory_order_relaxed))
+    {
+        unlockPush();
+        return false;
+    }
+
+    std::size_t size = TouchRecording::frameSize(numTouches);
+    std::size_t writePosition = _writePosition.load(std::memory_order_relaxed);
+    std::size_t readPosition = _readPosition.load(std::memory_order_acquire);
+
+    if (_buffer.size() - (writePosition - readPosition) < size)
+    {
+        unlockPush();
+        _droppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    TouchRecording::FrameHeader header;
+    header.deviceId = deviceId;
+    header.numTouches = numTouches;
+    header.timestamp = timestamp;
+    header.frameNum = frameNum;
+    header.reserved = 0;
+
+    write(&header, sizeof(header), writePosition);
+    write(touches, numTouches * sizeof(MTTouch), writePosition + sizeof(header));
+
+    _writePosition.store(writePosition + size, std::memory_order_release);
+    unlockPush();
+    _recordedFrameCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+
+uint64_t TouchRecorder::recordedFrameCount() const
+{
+    return _recordedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+uint64_t TouchRecorder::droppedFrameCount() const
+{
+    return _droppedFrameCount.load(std::memory_order_relaxed);
+}
+
+
+bool TouchRecorder::hasWriteError() const
+{
+    return _hasWriteError.load(std::memory_order_relaxed);
+}
+
+
+void TouchRecorder::write(const void* data, std::size_t size, std::size_t position)
+{
+    if (size == 0)
+    {
+        return;
+    }
+
+    // Positions increase monotonically and wrap around the ring.
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    std::size_t offset = position % _buffer.size();
+    std::size_t first = std::min(size, _buffer.size() - offset);
+
+    std::memcpy(_buffer.data() + offset, bytes, first);
+    std::memcpy(_buffer.data(), bytes + first, size - first);
+}
+
+
+void TouchRecorder::writerThread()
+{
+    while (isRecording())
+    {
+        flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+}
+
+
+void TouchRecorder::flush()
+{
+    std::size_t readPosition = _readPosition.load(std::memory_order_relaxed);
+    std::size_t writePosition = _writePosition.load(std::memory_order_acquire);
+
+    while (readPosition != writePosition)
+    {
+        // The ring already holds the file format, so spans are written as is.
+        std::size_t offset = readPosition % _buffer.size();
+        std::size_t size = std::min(writePosition - readPosition, _buffer.size() - offset);
+
+        if (std::fwrite(_buffer.data() + offset, 1, size, _file) != size)
+        {
+            // The span is skipped anyway, so the ring doesn't fill up.
+            reportWriteError("write");
+        }
+
+        readPosition += size;
+        _readPosition.store(readPosition, std::memory_order_release);
+    }
+
+    if (std::fflush(_file) != 0)
+    {
+        reportWriteError("flush");
+    }
+}
+
+
+void TouchRecorder::reportWriteError(const char* operation)
+{
+    if (!_hasWriteError.exchange(true, std::memory_order_relaxed))
+    {
+        ofLogError("TouchRecorder::reportWriteError") << "Unable to " << operation << " the recording: " << std::strerror(errno) << ". Frames are being lost.";
+    }
+}
+
+
+void TouchRecorder::lockPush()
+{
+    while (_isPushing.exchange(true, std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+}
+
+
+void TouchRecorder::unlockPush()
+{
+    _isPushing.store(false, std::memory_order_release);
+}
+
+
+} // namespace ofx
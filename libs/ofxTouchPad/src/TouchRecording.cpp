@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2010 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:	GPL
+//
+
+
+#include "ofx/TouchRecording.h"
+#include <cstddef>
+#include <cstring>
+
+
+namespace ofx {
+
+
+static_assert(sizeof(TouchRecording::FileHeader) == 32, "Unexpected FileHeader size.");
+static_assert(sizeof(TouchRecording::FieldInfo) == 32, "Unexpected FieldInfo size.");
+static_assert(sizeof(TouchRecording::FrameHeader) == 24, "Unexpected FrameHeader size.");
+
+
+namespace {
+
+
+TouchRecording::FieldInfo makeField(const char* name,
+                                    std::size_t offset,
+                                    std::size_t size,
+                                    TouchRecording::FieldType type)
+{
+    TouchRecording::FieldInfo field;
+    std::memset(&field, 0, sizeof(field));
+    std::strncpy(field.name, name, TouchRecording::FIELD_NAME_LENGTH - 1);
+    field.offset = static_cast<uint32_t>(offset);
+    field.size = static_cast<uint32_t>(size);
+    field.type = type;
+    return field;
+}
+
+
+} // namespace
+
+
+#define OFX_TOUCH_FIELD(member, type) \
+    makeField(#member, offsetof(MTTouch, member), sizeof(MTTouch::member), TouchRecording::type)
+
+
+const char* TouchRecording::magic()
+{
+    return "OFXTPREC";
+}
+
+
+std::vector<TouchRecording::FieldInfo> TouchRecording::touchFields()
+{
+    return {
+        OFX_TOUCH_FIELD(frame, FIELD_INT32),
+        OFX_TOUCH_FIELD(timestamp, FIELD_FLOAT64),
+        OFX_TOUCH_FIELD(pathIndex, FIELD_INT32),
+        OFX_TOUCH_FIELD(phase, FIELD_INT32),
+        OFX_TOUCH_FIELD(fingerID, FIELD_INT32),
+        OFX_TOUCH_FIELD(handID, FIELD_INT32),
+        OFX_TOUCH_FIELD(normalizedVector.position.x, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(normalizedVector.position.y, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(normalizedVector.velocity.x, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(normalizedVector.velocity.y, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(zTotal, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(UNKNOWN_0, FIELD_INT32),
+        OFX_TOUCH_FIELD(angle, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(majorAxis, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(minorAxis, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(absoluteVector.position.x, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(absoluteVector.position.y, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(absoluteVector.velocity.x, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(absoluteVector.velocity.y, FIELD_FLOAT32),
+        OFX_TOUCH_FIELD(UNKNOWN_1, FIELD_INT32),
+        OFX_TOUCH_FIELD(UNKNOWN_2, FIELD_INT32),
+        OFX_TOUCH_FIELD(zDensity, FIELD_FLOAT32)
+    };
+}
+
+
+#undef OFX_TOUCH_FIELD
+
+
+TouchRecording::FileHeader TouchRecording::makeFileHeader()
+{
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.touchSize = sizeof(MTTouch);
+    header.numFields = static_cast<uint32_t>(touchFields().size());
+    header.headerSize = sizeof(FileHeader) + header.numFields * sizeof(FieldInfo);
+    return header;
+}
+
+
+std::size_t TouchRecording::frameSize(int32_t numTouches)
+{
+    return sizeof(FrameHeader) + static_cast<std::size_t>(numTouches) * sizeof(MTTouch);
+}
+
+
+} // namespace ofx
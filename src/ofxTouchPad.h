@@ -9,4 +9,11 @@
 
 
 #include "ofx/MTTypes.h"
+#include "ofx/DeviceManager.h"
+#include "ofx/EvdevDecoder.h"
+#include "ofx/EvdevFrameSource.h"
+#include "ofx/FrameSource.h"
+#include "ofx/InputThread.h"
+#include "ofx/MultitouchSupportFrameSource.h"
+#include "ofx/ReplayFrameSource.h"
 #include "ofx/TouchPad.h"